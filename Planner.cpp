@@ -8,7 +8,11 @@
  *  @bug No known bugs.
  */
 
+#include <cassert>
 #include <cfloat>
+#include <chrono>
+#include <climits>
+#include <queue>
 #include <vector>
 #include <random>
 
@@ -17,271 +21,461 @@
 #include "utils/Graph.h"
 #include "utils/Map.h"
 #include "utils/Point.h"
-#include "utils/Search.h"
 #include "utils/KDTree.h"
+#include "utils/Trace.h"
 
 using namespace std;
 
 /****************************************************************************/
 
-                            /* Planner Utils */
+                                /* Deadline */
 
 /****************************************************************************/
 
 /**
- * @brief Constructor with initial point.
+ * @brief Constructor for a deadline that never expires.
  * 
- * @param init_pt Initial Point.
- * @return Planner Util object with init_pt.
+ * @return Deadline at the end of time.
  */
-Planner_Utils::Planner_Utils(Point *init_pt) {
-  assert(init_pt != NULL);
-
-  this->parents = unordered_map<Point*, Point*>();
-  this->costs = unordered_map<Point*, double>();
-
-  this->parents[init_pt] = NULL;
-  this->costs[init_pt] = 0;
+Deadline::Deadline() {
+  this->time = chrono::steady_clock::time_point::max();
+  this->last_check = chrono::steady_clock::now();
+  this->period = INT_MAX;
+  this->countdown = INT_MAX;
+  this->passed = false;
 }
 
 /**
- * @brief Get the parent of a point.
+ * @brief Constructor for a deadline at the given time.
  * 
- * @param p A Point.
- * @return A pointer to the parent of of p.
+ * @param time Point in time on the monotonic clock.
+ * @return Deadline at time.
  */
-Point* Planner_Utils::get_parent(Point *p) {
-  assert(p != NULL);
-  assert(this->parents.find(p) != this->parents.end());
-  return this->parents[p];
+Deadline::Deadline(chrono::steady_clock::time_point time) {
+  this->time = time;
+  this->last_check = chrono::steady_clock::now();
+  this->period = 1;
+  this->countdown = 0; /* Read the clock on the first check */
+  this->passed = false;
 }
 
 /**
- * @brief Get the cost of a point from the initial point.
+ * @brief Checks whether the deadline has passed. The clock is only read
+ * every few calls, so callers may check it every step. The number of calls
+ * between reads doubles while reads are much closer than DEADLINE_CHECK_US
+ * apart. When they are further apart it is cut in proportion to the time
+ * that passed, so one slow call brings the next read back within about
+ * DEADLINE_CHECK_US, and it never lets the reads run past the deadline at
+ * the pace of the last gap.
  * 
- * @param p A Point.
- * @return The cost of p.
+ * @return True once the deadline has passed.
  */
-double Planner_Utils::get_cost(Point *p) {
-  assert(p != NULL);
-  assert(this->costs.find(p) != this->costs.end());
-  return this->costs[p];
-}
+bool Deadline::expired() {
+  if (this->passed) { return true; }
+  if (this->countdown-- > 0) { return false; }
+
+  auto now = chrono::steady_clock::now();
+  if (now >= this->time) {
+    this->passed = true;
+    return true;
+  }
 
-/**
- * @brief Adds point with its info to Planner_Utils objects.
- * 
- * @param p A Point.
- * @param parent Parent of point p.
- * @param cost cost of point p.
- * @return Void.
- */
-void Planner_Utils::add_point(Point *p, Point *parent, double cost) {
-  assert(p != NULL);
-  this->parents[p] = parent;
-  this->costs[p] = cost;
+  chrono::duration<double, micro> gap = now - this->last_check;
+  chrono::duration<double, micro> left = this->time - now;
+  double per_call_us = max(gap.count() / this->period, 1e-3);
+  if (gap.count() > DEADLINE_CHECK_US) {
+    this->period = max(1, (int) (this->period * DEADLINE_CHECK_US / gap.count()));
+  } else if (4 * gap.count() < DEADLINE_CHECK_US && this->period < DEADLINE_MAX_PERIOD) {
+    this->period *= 2;
+  }
+  double calls_left = left.count() / per_call_us / 2;
+  if (calls_left < this->period) { this->period = max(1, (int) calls_left); }
+  this->last_check = now;
+  this->countdown = this->period - 1;
+  return false;
 }
 
 /**
- * @brief Updates the parent of point p.
+ * @brief Checks whether work that cannot be interrupted would finish well
+ * before the deadline. Always reads the clock, so it is meant to be called
+ * only before such work. If the work goes ahead, the next call to expired
+ * reads the clock, so that the time it took counts against the number of
+ * calls between reads instead of hiding inside one of them.
  * 
- * @param p A Point.
- * @param parent New parent.
- * @return Void.
+ * @param work Time the work is expected to take.
+ * @return True if DEADLINE_WORK_MARGIN times work fits before the deadline.
  */
-void Planner_Utils::set_parent(Point *p, Point *parent) {
-  assert(p != NULL);
-  this->parents[p] = parent;
+bool Deadline::has_time_for(chrono::nanoseconds work) {
+  if (this->passed) { return false; }
+  if (this->time == chrono::steady_clock::time_point::max()) { return true; }
+  auto now = chrono::steady_clock::now();
+  if (now >= this->time) {
+    this->passed = true;
+    return false;
+  }
+  if (this->time - now <= DEADLINE_WORK_MARGIN * work) { return false; }
+  this->period -= this->countdown; /* Calls made since the last read */
+  this->countdown = 0;
+  return true;
 }
 
 /**
- * @brief Updates the cost of point p.
+ * @brief Time elapsed since the deadline.
  * 
- * @param p A Point.
- * @param cost New cost.
- * @return Void.
+ * @return Milliseconds past the deadline, or 0 if it has not passed.
  */
-void Planner_Utils::set_cost(Point *p, double cost) {
-  assert(p != NULL);
-  this->costs[p] = cost;
+double Deadline::overshoot_ms() const {
+  if (this->time == chrono::steady_clock::time_point::max()) { return 0; }
+  chrono::duration<double, milli> late = chrono::steady_clock::now() - this->time;
+  return max(late.count(), 0.0);
 }
 
 
 
 /****************************************************************************/
 
-                            /* Helper Functions */
+                              /* Replanning */
 
 /****************************************************************************/
 
 /**
- * @brief Samples a random point inside the map.
+ * @brief Constructor for a replanner that has not planned yet.
  * 
- * @param width Map width.
- * @param height Map height.
- * @return A point inside the dimensions of the map.
+ * @param start Starting Point, copied.
+ * @param goal Target Point, must outlive the replanner.
+ * @param map A map object.
+ * @return Replanner whose first call to replan grows a new tree.
  */
-Point sample(float width, float height) {
-  /* -width <= x < width */
-  double x = (((double) rand() / (RAND_MAX)) * 2 * width) - width;
-  /* -height <= y < height */
-  double y = (((double) rand() / (RAND_MAX)) * 2 * height) - height;
-  return Point(x, y);
+Replanner::Replanner(Point *start, Point *goal, Map &map) : map(map) {
+  this->state = new RRT_Star_Tree(new Point(*start), goal);
 }
 
 /**
- * @brief Repeatedly samples random points inside the map until it is obstacle
- * free.
+ * @brief Deletes the tree together with all of the points it owns.
+ */
+Replanner::~Replanner() {
+  for (auto entry : this->state->utils.parents) {
+    if (entry.first != this->state->goal) { delete entry.first; }
+  }
+  delete this->state;
+}
+
+/**
+ * @brief Throws the tree away and starts over from start.
  * 
- * @param map A map object.
- * @return A point inside the dimensions of the map and free of obstacles.
+ * @param start New root, owned by the tree.
+ * @return Void.
+ */
+void Replanner::reset(Point *start) {
+  Point *goal = this->state->goal;
+  for (auto entry : this->state->utils.parents) {
+    if (entry.first != goal) { delete entry.first; }
+  }
+  delete this->state;
+  this->state = new RRT_Star_Tree(start, goal);
+}
+
+/**
+ * @brief Takes the goal out of the tree once it is cut off from the root, so
+ * that grow_rrt_star samples it again. Its children stay behind as orphans
+ * with infinite cost, like the rest of the subtree it was in.
+ * 
+ * @param t Tree being repaired.
+ * @return Void.
  */
-Point *get_rand_config(Map &map) {
-  Point rand_p = sample(map.width, map.height);
+void release_orphaned_goal(RRT_Star_Tree &t) {
+  auto goal_cost = t.utils.costs.find(t.goal);
+  if (goal_cost == t.utils.costs.end() || goal_cost->second != DBL_MAX) { return; }
 
-  while (!map.is_freespace(rand_p)) {
-    rand_p = sample(map.width, map.height);
+  for (Point *child : t.graph.get_neighbors(t.goal)) {
+    if (t.utils.get_parent(child) == t.goal) { t.utils.set_parent(child, NULL); }
   }
-  
-  return new Point(rand_p);
+  t.graph.remove_vertex(t.goal);
+  t.tree->remove_node(t.goal);
+  t.utils.remove_point(t.goal);
 }
 
 /**
- * @brief Returns a new point in the direction of the goal from start with at
- * most distance EPSILON.
+ * @brief Re-roots the tree at start. Start is attached to the nearest node
+ * and the parent pointers from that node up to the old root are reversed, so
+ * the whole tree hangs off the new root. Costs are recomputed and, once a
+ * solution is known, every node that can no longer lie on a shorter path
+ * from start to goal is pruned, which removes the branches behind the robot.
+ * Falls back to a new tree if start cannot see the nearest node, or if an
+ * obstacle has emptied the tree.
  * 
- * @param map A map object.
- * @return A point inside the dimensions of the map and free of obstacles.
+ * @param start New root, owned by the tree.
+ * @return Void.
  */
-Point* new_config(Point *start, Point *goal) {
-  if(start->dist(*goal) <= EPSILON) {
-    return goal;
+void Replanner::reroot(Point *start) {
+  RRT_Star_Tree &t = *this->state;
+  Point *near_p = t.tree->nearest_neighbor(start);
+  if (near_p == NULL || !this->map.is_valid_path(*start, *near_p)) {
+    reset(start);
+    return;
   }
 
-  double theta = start->angle(*goal);
-  double x = start->x + EPSILON * cos(theta);
-  double y = start->y + EPSILON * sin(theta);
-  return new Point(x, y);
+  Point *prev = start;
+  Point *curr = near_p;
+  while (curr != NULL) {
+    Point *next = t.utils.get_parent(curr);
+    t.utils.set_parent(curr, prev);
+    prev = curr;
+    curr = next;
+  }
+  /* Reversing from an orphan leaves the old root's side cut off, unless an
+   * obstacle already removed the old root */
+  Point *old_root = t.root;
+  if (old_root != NULL && prev != old_root) {
+    t.utils.set_cost(old_root, DBL_MAX);
+    propagate_cost(t.graph, old_root, t.utils);
+  }
+
+  t.utils.add_point(start, NULL, 0);
+  t.utils.set_cost(near_p, start->dist(*near_p));
+  t.graph.add_edge(start, near_p);
+  t.tree->insert_node(start);
+  t.max_edge = max(t.max_edge, start->dist(*near_p));
+  t.root = start;
+  propagate_cost(t.graph, near_p, t.utils);
+  release_orphaned_goal(t);
+
+  t.solved = is_reached(t);
+  t.c_best = t.solved ? t.utils.get_cost(t.goal) : DBL_MAX;
+  if (t.solved) {
+    t.tree = prune_tree(t.graph, t.tree, t.utils, t.root, t.goal, t.c_best);
+  }
+  t.c_pruned = t.c_best;
+  t.pruned_size = t.utils.parents.size();
 }
 
 /**
- * @brief Tries to extend a branch from the tree to the goal by at most 
- * EPSILON
+ * @brief Checks whether the bounding box of segment AB overlaps the box
+ * [lo, hi].
  * 
- * @param graph Graph of entire explored space.
- * @param tree Tree to extend from.
- * @param goal Goal point to extend to.
- * @param map A map object.
- * @return A point inside the dimensions of the map and free of obstacles.
+ * @return True if the boxes overlap.
  */
-pair<Point*, status_t> extend(Graph<Point> &graph, KDTree *tree, Point *goal, Map &map) {
-    Point *near_p = tree->nearest_neighbor(goal);
-    Point *new_p = new_config(near_p, goal);
-    if (map.is_valid_path(*near_p, *new_p)) {
-        graph.add_edge(new_p, near_p);
-        if (new_p == goal) { /* Equality test is on pointers */
-          return {goal, REACHED};
-        }
-        tree->insert_node(new_p); /* Only add new_p if it's not already there */
-        return {new_p, ADVANCED};
+bool segment_box_overlap(const Point &A, const Point &B, const Point &lo,
+                         const Point &hi) {
+  return max(A.x, B.x) >= lo.x && min(A.x, B.x) <= hi.x &&
+         max(A.y, B.y) >= lo.y && min(A.y, B.y) <= hi.y;
+}
+
+/* Candidate edge to reattach an orphaned node through */
+struct Reattach {
+  double cost;
+  Point *node;
+  Point *parent;
+
+  bool operator < (const Reattach &other) const {
+    return this->cost > other.cost; /* Cheapest first in a priority_queue */
+  }
+};
+
+/**
+ * @brief Queues every edge from an attached node within SEARCH_RADIUS of
+ * orphan to it.
+ * 
+ * @return Void.
+ */
+void queue_reattach(RRT_Star_Tree &t, Map &map, Point *orphan,
+                    priority_queue<Reattach> &frontier) {
+  for (Point *neighbor : t.tree->points_in_radius(orphan, SEARCH_RADIUS)) {
+    double cost = t.utils.get_cost(neighbor);
+    if (cost == DBL_MAX) { continue; }
+    cost += neighbor->dist(*orphan);
+    if (map.is_valid_path(*neighbor, *orphan)) {
+      frontier.push({cost, orphan, neighbor});
     }
-    if(new_p != goal) { delete new_p; }
-    return {NULL, TRAPPED};
+  }
 }
 
 /**
- * @brief Tries to extend a branch from the tree to the goal by at most 
- * EPSILON and rewires the nearby nodes
+ * @brief Attaches orphans cheapest first until the frontier runs out. Each
+ * attached node brings its old children back and offers itself as a parent
+ * to the roots of other orphaned subtrees around it, as long as some of
+ * those roots are still detached.
  * 
- * @param graph Graph of entire explored space.
- * @param tree Tree to extend from.
- * @param goal Goal point to extend to.
+ * @param t Tree being repaired.
  * @param map A map object.
- * @return A point inside the dimensions of the map and free of obstacles.
+ * @param obs The obstacle that orphaned the nodes.
+ * @param frontier Candidate edges, cheapest first.
+ * @param detached Number of subtree roots outside the obstacle.
+ * @return Void.
  */
-pair<Point*, status_t> extend_rewired(Graph<Point> &graph, KDTree *tree, Point *goal,
-                                       Planner_Utils &utils, Map &map) {
-    Point *near_p = tree->nearest_neighbor(goal);
-    Point *new_p = new_config(near_p, goal);
-    if (map.is_valid_path(*near_p, *new_p)) {
-      tree->insert_node(new_p);
-      double path_cost = utils.get_cost(near_p) + near_p->dist(*new_p);
-      utils.add_point(new_p, near_p, path_cost);
-
-      Point *min_p = near_p;
-      unordered_set<Point*> nearest = tree->points_in_radius(new_p, SEARCH_RADIUS);
-
-      /* Check all nearby points to see if theirs better path to new_p */
-      double min_cost = DBL_MAX;
-      Point *parent = NULL;
-      for (Point *neighbor : nearest) {
-        if (map.is_valid_path(*neighbor, *new_p)) {
-          double path_cost = utils.get_cost(neighbor) + neighbor->dist(*new_p);
-          if(path_cost < utils.get_cost(new_p)) {
-            min_p = neighbor;
-            min_cost = path_cost;
-            parent = neighbor;
-          }
-        }
-      }
+void reattach_orphans(RRT_Star_Tree &t, Map &map, const Obstacle &obs,
+                      priority_queue<Reattach> &frontier, int detached) {
+  while (!frontier.empty()) {
+    Reattach r = frontier.top();
+    frontier.pop();
+    if (t.utils.get_cost(r.node) != DBL_MAX) { continue; }
+
+    Point *old_parent = t.utils.get_parent(r.node);
+    if (old_parent == NULL) { detached--; }
+    if (old_parent != r.parent) {
+      if (old_parent != NULL) { t.graph.remove_edge(old_parent, r.node); }
+      t.graph.add_edge(r.parent, r.node);
+      t.utils.set_parent(r.node, r.parent);
+    }
+    t.utils.set_cost(r.node, r.cost);
 
-      graph.add_edge(min_p, new_p);
-      utils.set_parent(new_p, parent);
-      utils.set_cost(new_p, min_cost);
-
-      /* Check if all other neighbors have shorter path through new_p */
-      for (Point *neighbor : nearest) {
-        if(neighbor == min_p) { continue; }
-        double path_cost = utils.get_cost(new_p) + new_p->dist(*neighbor);
-        if (map.is_valid_path(*neighbor, *new_p) && 
-            path_cost < utils.get_cost(neighbor)) {
-          Point* parent = utils.get_parent(neighbor);
-          graph.remove_edge(parent, neighbor);
-          graph.add_edge(new_p, neighbor);
-          utils.set_parent(neighbor, new_p);
-          utils.set_cost(neighbor, path_cost);   
-        }
+    for (Point *child : t.graph.get_neighbors(r.node)) {
+      if (t.utils.get_parent(child) == r.node && t.utils.get_cost(child) == DBL_MAX) {
+        frontier.push({r.cost + r.node->dist(*child), child, r.node});
       }
-
-      if (new_p == goal) { /* Equality test is on pointers */
-        return {goal, REACHED};
+    }
+    if (detached == 0) { continue; }
+    for (Point *neighbor : t.tree->points_in_radius(r.node, SEARCH_RADIUS)) {
+      if (t.utils.get_cost(neighbor) != DBL_MAX ||
+          t.utils.get_parent(neighbor) != NULL || obs.collides(*neighbor)) {
+        continue;
+      }
+      if (map.is_valid_path(*r.node, *neighbor)) {
+        frontier.push({r.cost + r.node->dist(*neighbor), neighbor, r.node});
       }
-      return {new_p, ADVANCED};
     }
-    if(new_p != goal) { delete new_p; }
-    return {NULL, TRAPPED};
+  }
 }
 
 /**
- * @brief Tries to extend a branch from the tree to the goal by at most 
- * EPSILON.
+ * @brief Adds an obstacle to the map and repairs the tree around it. Only
+ * nodes within the longest tree edge of the obstacle's bounding box are
+ * looked at, and only edges whose bounding box overlaps it are checked. The
+ * subtrees hanging off invalid edges are orphaned and then reattached
+ * cheapest first, each orphan either following its old parent back in or
+ * connecting to a nearby node of the tree. Orphans that cannot be reattached
+ * keep infinite cost, and nodes inside the obstacle are removed. A goal
+ * left unreachable is taken out of the tree, and so is a root inside the
+ * obstacle, in which case the next replan roots the tree at the robot
+ * again.
  * 
- * @param graph Graph of entire explored space.
- * @param tree Tree to extend from.
- * @param goal Goal point to extend to.
- * @param map A map object.
- * @return A point inside the dimensions of the map and free of obstacles.
+ * @param o The new obstacle.
+ * @return Void.
  */
-pair<Point*, status_t> connect(Graph<Point> &graph, KDTree *tree, Point *goal, Map &map) {
-    pair<Point*, status_t> p_status;
-    status_t status = ADVANCED;
-    while (status == ADVANCED) {
-        p_status = extend(graph, tree, goal, map);
-        status = p_status.second;
+void Replanner::add_obstacle(const Obstacle &o) {
+  this->map.add_obstacle(o);
+  RRT_Star_Tree &t = *this->state;
+  const Obstacle &obs = this->map.minkowski.back();
+
+  const Point &lo = obs.lo;
+  const Point &hi = obs.hi;
+  Point pad(t.max_edge, t.max_edge);
+
+  /* Cut every tree edge that passes through the obstacle */
+  vector<Point*> orphans;
+  for (Point *p : t.tree->points_in_box(lo - pad, hi + pad)) {
+    Point *parent = t.utils.get_parent(p);
+    if (parent == NULL || !segment_box_overlap(*parent, *p, lo, hi)) { continue; }
+    if (obs.path_collides(*parent, *p)) {
+      t.graph.remove_edge(parent, p);
+      t.utils.set_parent(p, NULL);
+      orphans.push_back(p);
+    }
+  }
+  bool root_blocked = t.root != NULL && obs.collides(*t.root);
+  if (orphans.empty() && !root_blocked) { return; }
+
+  /* Mark the whole orphaned subtrees as unreachable */
+  for (size_t i = 0; i < orphans.size(); i++) {
+    Point *p = orphans[i];
+    t.utils.set_cost(p, DBL_MAX);
+    for (Point *child : t.graph.get_neighbors(p)) {
+      if (t.utils.get_parent(child) == p) { orphans.push_back(child); }
+    }
+  }
+
+  /* Reattach cheapest first. Edges to old children are still valid, so only
+   * the roots of the orphaned subtrees look for new parents. */
+  priority_queue<Reattach> frontier;
+  int detached = 0;
+  for (Point *p : orphans) {
+    if (t.utils.get_parent(p) == NULL && !obs.collides(*p)) {
+      queue_reattach(t, this->map, p, frontier);
+      detached++;
     }
-    return p_status;
+  }
+  reattach_orphans(t, this->map, obs, frontier, detached);
+
+  /* Nodes inside the obstacle go. The other orphans stay in the tree with
+   * infinite cost until rewiring around a new sample picks them back up. */
+  if (root_blocked) { orphans.push_back(t.root); }
+  for (Point *p : orphans) {
+    if (!obs.collides(*p)) { continue; }
+    t.graph.remove_vertex(p);
+    t.tree->remove_node(p);
+    t.utils.remove_point(p);
+    if (p == t.root) { t.root = NULL; }
+    if (p != t.goal) { delete p; }
+  }
+  release_orphaned_goal(t);
+
+  t.solved = is_reached(t);
+  t.c_best = t.solved ? t.utils.get_cost(t.goal) : DBL_MAX;
+  t.c_pruned = t.c_best;
 }
 
+/**
+ * @brief Removes an obstacle from the map and lets the nodes around it take
+ * the shortcuts it opens. Only nodes within the longest tree edge of the
+ * obstacle's bounding box are looked at, and only connections whose bounding
+ * box overlaps it are checked, since no other connection changed validity.
+ * 
+ * @param index Position of the obstacle in the map.
+ * @return Void.
+ */
+void Replanner::remove_obstacle(int index) {
+  RRT_Star_Tree &t = *this->state;
+  Point lo = this->map.minkowski[index].lo;
+  Point hi = this->map.minkowski[index].hi;
+  this->map.remove_obstacle(index);
+
+  Point pad(t.max_edge, t.max_edge);
+  for (Point *p : t.tree->points_in_box(lo - pad, hi + pad)) {
+    for (Point *neighbor : t.tree->points_in_radius(p, SEARCH_RADIUS)) {
+      if (!segment_box_overlap(*neighbor, *p, lo, hi)) { continue; }
+      double cost = t.utils.get_cost(neighbor) + neighbor->dist(*p);
+      if (cost < t.utils.get_cost(p) && this->map.is_valid_path(*neighbor, *p)) {
+        Point *parent = t.utils.get_parent(p);
+        if (parent != NULL) { t.graph.remove_edge(parent, p); }
+        t.graph.add_edge(neighbor, p);
+        t.utils.set_parent(p, neighbor);
+        t.utils.set_cost(p, cost);
+        propagate_cost(t.graph, p, t.utils);
+      }
+    }
+  }
+
+  t.solved = is_reached(t);
+  t.c_best = t.solved ? t.utils.get_cost(t.goal) : DBL_MAX;
+}
 
 /**
- * @brief Supplies heuristic function based on distance between node and goal.
+ * @brief Plans from start reusing the tree of the previous call, growing and
+ * refining it until either budget runs out.
  * 
- * @param n Original Point.
- * @param goal Goal Point.
- * @return Euclidean distance between n and target.
+ * @param start Current position of the robot, copied.
+ * @param num_iterations Maximum number of samples to draw.
+ * @param deadline Time on the monotonic clock to return by.
+ * @return Best path to the target found in time, otherwise the path to the
+ * node closest to the target. The result carries no tree, the tree is
+ * available in state.
  */
-double heuristic(Point *n, Point *goal) {
-  return n->dist(*goal);
+PlanResult Replanner::replan(Point *start, int num_iterations,
+                             chrono::steady_clock::time_point deadline) {
+  Memory_Scope memory;
+  Point *root = this->state->root;
+  if (root == NULL || !(*start == *root)) {
+    reroot(new Point(*start));
+  }
+  /* Samples joined to orphans can bring the goal back in unreachable */
+  release_orphaned_goal(*this->state);
+
+  Deadline d(deadline);
+  Config_Space<2, double> space(this->map);
+  PlanResult result = grow_rrt_star(*this->state, space, num_iterations, d, true, NULL);
+  result.overshoot_ms = d.overshoot_ms();
+  result.memory = memory.usage();
+  return result;
 }
 
 /****************************************************************************/
@@ -290,41 +484,28 @@ double heuristic(Point *n, Point *goal) {
 
 /****************************************************************************/
 
+thread_local Graph_Listener<Point> *Planner::listener = NULL;
+double Planner::nn_epsilon = NN_EPSILON;
+
 /**
  * @brief RRT-Connect Planner to build random tree and return path
  * 
  * @param start Starting Point.
  * @param goal Target Point.
  * @param map A map object.
- * @return Path from start to target and the underlying graph.
+ * @return Path from start to target and the tree it was found in.
  */
-pair<vector<Point*>, Graph<Point>> Planner::RRT_connect(Point *start, Point *goal, Map &map) {
-  KDTree *treeA = new KDTree(start);
-  KDTree *treeB = new KDTree(goal);
-  Graph<Point> graph(start);
-  pair<Point*, status_t> p_status;
-  
-  for (int i = 0; i < MAX_NODES; i++) {
-      Point *rand_config = get_rand_config(map);
-
-      p_status = extend(graph, treeA, rand_config, map);
-      if (p_status.second != REACHED) { delete rand_config; }
-      if (p_status.second != TRAPPED) {
-          p_status = connect(graph, treeB, p_status.first, map);
-          if (p_status.second == REACHED) {
-              delete treeA;
-              delete treeB;
-              vector<Point*> path = Search<Point>::a_star(start, goal, graph, heuristic);
-              return {path, graph};
-          }
-          swap(treeA, treeB); /* built in swap function */
-      }
+PlanResult Planner::RRT_connect(Point *start, Point *goal, Map &map) {
+  Config_Space<2, double> space(map);
+  Deadline never;
+  Memory_Scope memory;
+  PlanResult result = rrt_connect(start, goal, space, MAX_NODES, never);
+  result.memory = memory.usage();
+  if (!result.converged) {
+    cout << "RRT Planner Failed" << endl;
+    result.path.clear();
   }
-    
-  delete treeA;
-  delete treeB;
-  cout << "RRT Planner Failed" << endl;
-  return {vector<Point*>(), Graph<Point>(NULL)};
+  return result;
 }
 
 /**
@@ -333,33 +514,120 @@ pair<vector<Point*>, Graph<Point>> Planner::RRT_connect(Point *start, Point *goa
  * @param start Starting Point.
  * @param goal Target Point.
  * @param map A map object.
- * @return Path from start to target and the underlying graph.
+ * @return Path from start to target and the tree it was found in.
  */
-pair<vector<Point*>, Graph<Point>> Planner::RRT_star(Point *start, Point *goal, Map &map) {
-  KDTree *tree = new KDTree(start);
-  Graph<Point> graph(start);
-  Planner_Utils utils(start);
-
-  pair<Point*, status_t> p_status;
-  
-  for (int i = 0; i < MAX_NODES; i++) {
-      double rand_num = ((double) rand() / (RAND_MAX));
-      Point *rand_config;
-      if(rand_num < GOAL_BIAS) { 
-        rand_config = goal;
-      } else {
-        rand_config = get_rand_config(map); 
-      }   
-      p_status = extend_rewired(graph, tree, rand_config, utils, map);
-      if (p_status.second != REACHED && rand_config != goal) { delete rand_config; }
-      if (p_status.first == goal) {
-        delete tree;
-        vector<Point*> path = Search<Point>::a_star(start, goal, graph, heuristic);
-        return {path, graph};
-      } 
+PlanResult Planner::RRT_star(Point *start, Point *goal, Map &map) {
+  Config_Space<2, double> space(map);
+  Deadline never;
+  Memory_Scope memory;
+  PlanResult result = rrt_star(start, goal, space, MAX_NODES, never, false, NULL);
+  result.memory = memory.usage();
+  if (!result.converged) {
+    cout << "RRT* Planner Failed" << endl;
+    result.path.clear();
   }
-    
-  delete tree;
-  cout << "RRT* Planner Failed" << endl;
-  return {vector<Point*>(), Graph<Point>(NULL)};
+  return result;
+}
+
+/**
+ * @brief RRT-Connect planner that returns by the given deadline.
+ * 
+ * @param start Starting Point.
+ * @param goal Target Point.
+ * @param map A map object.
+ * @param deadline Time on the monotonic clock to return by.
+ * @return Path to the target if found in time, otherwise the path to the node
+ * closest to the target.
+ */
+PlanResult Planner::RRT_connect(Point *start, Point *goal, Map &map,
+                                chrono::steady_clock::time_point deadline) {
+  Config_Space<2, double> space(map);
+  return RRT_connect(start, goal, space, deadline);
+}
+
+/**
+ * @brief Anytime RRT-star planner that refines its path until the given
+ * deadline.
+ * 
+ * @param start Starting Point.
+ * @param goal Target Point.
+ * @param map A map object.
+ * @param deadline Time on the monotonic clock to return by.
+ * @return Best path to the target found in time, otherwise the path to the
+ * node closest to the target.
+ */
+PlanResult Planner::RRT_star(Point *start, Point *goal, Map &map,
+                             chrono::steady_clock::time_point deadline) {
+  Config_Space<2, double> space(map);
+  return RRT_star(start, goal, space, deadline);
+}
+
+/**
+ * @brief Anytime Informed RRT* planner. Keeps refining the tree for the full
+ * iteration budget after the goal is first reached, sampling only from the
+ * ellipse of points that can still shorten the path and pruning nodes
+ * outside of it.
+ * 
+ * @param start Starting Point.
+ * @param goal Target Point.
+ * @param map A map object.
+ * @param num_iterations Number of samples to draw.
+ * @param curve Filled with the best cost after each improvement.
+ * @return Path from start to target and the tree it was found in.
+ */
+PlanResult Planner::RRT_star_informed(Point *start, Point *goal, Map &map,
+                                      int num_iterations, vector<Cost_Sample> &curve) {
+  Config_Space<2, double> space(map);
+  Deadline never;
+  Memory_Scope memory;
+  PlanResult result = rrt_star(start, goal, space, num_iterations, never, true, &curve);
+  result.memory = memory.usage();
+  if (!result.converged) {
+    cout << "Informed RRT* Planner Failed" << endl;
+    result.path.clear();
+  }
+  return result;
+}
+
+/**
+ * @brief Anytime bidirectional RRT* planner. Finds a first path about as
+ * quickly as RRT-Connect and keeps shortening it for the full iteration
+ * budget.
+ * 
+ * @param start Starting Point.
+ * @param goal Target Point.
+ * @param map A map object.
+ * @param num_iterations Number of samples to draw.
+ * @param curve Filled with the best cost after each improvement.
+ * @return Path from start to target and the trees it was found in.
+ */
+PlanResult Planner::RRT_star_connect(Point *start, Point *goal, Map &map,
+                                     int num_iterations, vector<Cost_Sample> &curve) {
+  Config_Space<2, double> space(map);
+  Deadline never;
+  Memory_Scope memory;
+  PlanResult result = rrt_star_connect(start, goal, space, num_iterations, never, &curve);
+  result.memory = memory.usage();
+  if (!result.converged) {
+    cout << "Bidirectional RRT* Planner Failed" << endl;
+    result.path.clear();
+  }
+  return result;
+}
+
+/**
+ * @brief Anytime bidirectional RRT* planner that refines its path until the
+ * given deadline.
+ * 
+ * @param start Starting Point.
+ * @param goal Target Point.
+ * @param map A map object.
+ * @param deadline Time on the monotonic clock to return by.
+ * @return Best path to the target found in time, otherwise the path to the
+ * node closest to the target.
+ */
+PlanResult Planner::RRT_star_connect(Point *start, Point *goal, Map &map,
+                                     chrono::steady_clock::time_point deadline) {
+  Config_Space<2, double> space(map);
+  return RRT_star_connect(start, goal, space, deadline);
 }
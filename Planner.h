@@ -2,6 +2,15 @@
  *  @file Planner.h
  *  @brief Defines an API for the RRT planning methods
  *
+ *  The planners are templated on the configuration, a PointT<D, Scalar>, and
+ *  reach the map through a Config_Space, see utils/ConfigSpace.h. Point is
+ *  the default instantiation, planned on a Map directly.
+ *
+ *  NOTE: The implementation of the templates is also found in this file
+ *  instead of Planner.cpp. This is necessary for templates. For more
+ *  information see:
+ *    https://isocpp.org/wiki/faq/templates#templates-defn-vs-decl
+ *
  *  @author Shashank Ojha (shashano)
  *  @author Serris Lew (snlew)
  *  @author David Bick (dbick)
@@ -11,12 +20,26 @@
 #ifndef __PLANNER_H
 #define __PLANNER_H
 
+#include <algorithm>
+#include <cassert>
+#include <cfloat>
+#include <chrono>
+#include <climits>
+#include <cmath>
+#include <cstdlib>
+#include <limits>
 #include <vector>
 #include <unordered_map>
+#include <unordered_set>
 
+#include "utils/ConfigSpace.h"
 #include "utils/Graph.h"
+#include "utils/KDTree.h"
 #include "utils/Map.h"
+#include "utils/Memory.h"
 #include "utils/Point.h"
+#include "utils/Random.h"
+#include "utils/Trace.h"
 
 typedef int status_t;
 
@@ -28,37 +51,1504 @@ typedef int status_t;
 #define MAX_NODES 4000
 #define EPSILON 0.2
 
-#define GOAL_BIAS 0.1 
+/* Trees grow from a node at most (1 + NN_EPSILON) times farther from the
+ * sample than the nearest one, see KDTree::nearest_neighbor */
+#define NN_EPSILON 0
+
+#define GOAL_BIAS 0.1
 #define SEARCH_RADIUS 2 /* This should be much bigger than EPSILON */
 
+/* RRT* rewires the nodes within gamma (log n / n)^(1/d) of a new node, for
+ * n nodes in its tree, and never farther than SEARCH_RADIUS. gamma is this
+ * margin times the bound of Karaman and Frazzoli for the volume sampled. */
+#define REWIRE_GAMMA_MARGIN 1.1
+
+/* Informed RRT* prunes the tree once the best cost drops by this fraction,
+ * or once it has grown by this fraction since it was last pruned */
+#define PRUNE_IMPROVEMENT 0.05
+#define PRUNE_GROWTH 0.25
+
+/* Costs are sums of many distances, each rounded to the Scalar of the
+ * configuration, so bounds on them allow this many of its ulps per unit */
+#define COST_TOLERANCE_ULPS 256
+
+/* Deadline::expired reads the clock every few calls, adapting how many so
+ * that reads are about DEADLINE_CHECK_US microseconds apart */
+#define DEADLINE_CHECK_US 50
+#define DEADLINE_MAX_PERIOD 1024
+
+/* Work that cannot be interrupted, such as a KD-tree relayout or a prune,
+ * only starts if it would fit this many times over before the deadline */
+#define DEADLINE_WORK_MARGIN 2
+
+/* Guess at the time a prune takes per node, until one has been timed */
+#define PRUNE_NS_PER_NODE 1000
+
 using namespace std;
 
 /* Used in RRT* to keep track of parents and costs of a node */
-class Planner_Utils {
+template <int D, typename Scalar = double>
+class Planner_UtilsT {
+  public:
+    typedef PointT<D, Scalar> Pt;
+
+    /* Data */
+    counted_map<Pt*, Pt*> parents;
+    counted_map<Pt*, double> costs;
+
+    /* Constructors */
+    Planner_UtilsT(Pt *init_pt);
+
+    /* Function Prototypes */
+    Pt* get_parent(Pt *p);
+    double get_cost(Pt *p);
+
+    void add_point(Pt *p, Pt *parent, double cost);
+    void set_parent(Pt *p, Pt *parent);
+    void set_cost(Pt *p, double cost);
+    void remove_point(Pt *p);
+};
+
+typedef Planner_UtilsT<2, double> Planner_Utils;
+
+/* Point in time a plan has to be returned by, checked cheaply in loops */
+class Deadline {
+  public:
+    /* Data */
+    chrono::steady_clock::time_point time;
+    chrono::steady_clock::time_point last_check;
+    int period;
+    int countdown;
+    bool passed;
+
+    /* Constructors */
+    Deadline();
+    Deadline(chrono::steady_clock::time_point time);
+
+    /* Function Prototypes */
+    bool expired();
+    bool has_time_for(chrono::nanoseconds work);
+    double overshoot_ms() const;
+};
+
+/* Path found by a planner together with the tree it explored. The result
+ * owns the tree and every point in it except start and goal, so it can be
+ * moved but not copied, and the path is only valid while it is alive. */
+template <int D, typename Scalar = double>
+class PlanResultT {
   public:
+    typedef PointT<D, Scalar> Pt;
+
     /* Data */
-    unordered_map<Point*, Point*> parents;
-    unordered_map<Point*, double> costs;
+    vector<Pt*> path;
+    bool converged;      /* False if path only leads to the closest approach */
+    int iterations;
+    double overshoot_ms; /* Time the planner returned past its deadline */
+    Mem_Usage memory;    /* Counted by utils/Memory.h while planning */
 
     /* Constructors */
-    Planner_Utils(Point *init_pt);
+    PlanResultT(Graph<Pt> *graph, Pt *start, Pt *goal);
+    PlanResultT(PlanResultT &&other);
+    PlanResultT(const PlanResultT &other) = delete;
+    ~PlanResultT();
 
     /* Function Prototypes */
-    Point* get_parent(Point *p);
-    double get_cost(Point *p);
+    PlanResultT& operator=(PlanResultT &&other);
+    PlanResultT& operator=(const PlanResultT &other) = delete;
+    bool has_tree() const;
+    const Graph<Pt>& tree() const;
+    double peak_bytes_per_node() const;
+
+  private:
+    Graph<Pt> *graph; /* NULL if the tree is owned elsewhere */
+    Pt *start;
+    Pt *goal;
+
+    void release();
+};
+
+typedef PlanResultT<2, double> PlanResult;
+
+/* One point on the cost-vs-time curve of an anytime planner */
+struct Cost_Sample {
+  double time_ms;
+  int iteration;
+  double cost;
+};
+
 
-    void add_point(Point *p, Point *parent, double cost);
-    void set_parent(Point *p, Point *parent);
-    void set_cost(Point *p, double cost);
+/* State of an RRT* search, kept alive between plans by the Replanner */
+template <int D, typename Scalar = double>
+class RRT_Star_TreeT {
+  public:
+    typedef PointT<D, Scalar> Pt;
+
+    /* Data */
+    Pt *root;
+    Pt *goal;
+    KDTreeT<D, Scalar> *tree;
+    Graph<Pt> graph;
+    Planner_UtilsT<D, Scalar> utils;
+    bool solved;
+    double c_best;      /* Cost of the best path to goal so far */
+    double c_pruned;    /* c_best when the tree was last pruned */
+    size_t pruned_size; /* Number of nodes left by the last prune */
+    double prune_ns_per_node; /* Time the last prune took per node */
+    double max_edge;    /* Longest edge ever added to the tree */
+
+    /* Constructors */
+    RRT_Star_TreeT(Pt *root, Pt *goal);
+    ~RRT_Star_TreeT();
 };
 
+typedef RRT_Star_TreeT<2, double> RRT_Star_Tree;
+
+/* Replans from the robot's current position by re-rooting the previous
+ * RRT* tree instead of growing a new one, and repairs the tree in place when
+ * obstacles appear or disappear. Every point in the tree except the goal is
+ * owned by the Replanner, so returned paths are only valid until the next
+ * call to replan or to an obstacle update, and results carry no tree. */
+class Replanner {
+  public:
+    /* Data */
+    Map &map;
+    RRT_Star_Tree *state;
+
+    /* Constructors */
+    Replanner(Point *start, Point *goal, Map &map);
+    ~Replanner();
+
+    /* Function Prototypes */
+    PlanResult replan(Point *start, int num_iterations,
+                      chrono::steady_clock::time_point deadline);
+    void reroot(Point *start);
+    void reset(Point *start);
+    void add_obstacle(const Obstacle &o);
+    void remove_obstacle(int index);
+};
 
 class Planner {
-  
+
   public:
+    /* Data */
+    static thread_local Graph_Listener<Point> *listener; /* Watches every tree
+                                                          * grown on this thread */
+    static double nn_epsilon; /* Error bound of the nearest neighbor queries
+                               * that pick the node to grow from */
+
     /* Function Prototypes */
-    static pair<vector<Point*>, Graph<Point>> RRT_connect(Point *start, Point *goal, Map &map);
-    static pair<vector<Point*>, Graph<Point>> RRT_star(Point *start, Point *goal, Map &map);
+    static PlanResult RRT_connect(Point *start, Point *goal, Map &map);
+    static PlanResult RRT_star(Point *start, Point *goal, Map &map);
+    static PlanResult RRT_connect(Point *start, Point *goal, Map &map,
+                                  chrono::steady_clock::time_point deadline);
+    static PlanResult RRT_star(Point *start, Point *goal, Map &map,
+                               chrono::steady_clock::time_point deadline);
+    static PlanResult RRT_star_informed(Point *start, Point *goal, Map &map,
+                                        int num_iterations, vector<Cost_Sample> &curve);
+    static PlanResult RRT_star_connect(Point *start, Point *goal, Map &map,
+                                       int num_iterations, vector<Cost_Sample> &curve);
+    static PlanResult RRT_star_connect(Point *start, Point *goal, Map &map,
+                                       chrono::steady_clock::time_point deadline);
+
+    /* Planners over any configuration space */
+    template <int D, typename Scalar>
+    static PlanResultT<D, Scalar> RRT_connect(PointT<D, Scalar> *start, PointT<D, Scalar> *goal,
+                                              Config_Space<D, Scalar> &space,
+                                              chrono::steady_clock::time_point deadline);
+    template <int D, typename Scalar>
+    static PlanResultT<D, Scalar> RRT_star(PointT<D, Scalar> *start, PointT<D, Scalar> *goal,
+                                           Config_Space<D, Scalar> &space,
+                                           chrono::steady_clock::time_point deadline);
+    template <int D, typename Scalar>
+    static PlanResultT<D, Scalar> RRT_star_informed(PointT<D, Scalar> *start,
+                                                    PointT<D, Scalar> *goal,
+                                                    Config_Space<D, Scalar> &space,
+                                                    int num_iterations,
+                                                    vector<Cost_Sample> &curve);
+    template <int D, typename Scalar>
+    static PlanResultT<D, Scalar> RRT_star_connect(PointT<D, Scalar> *start,
+                                                   PointT<D, Scalar> *goal,
+                                                   Config_Space<D, Scalar> &space,
+                                                   chrono::steady_clock::time_point deadline);
+};
+
+/* Listener of the trees of a configuration space, only planar trees are
+ * watched since tree streams are planar */
+template <int D, typename Scalar>
+Graph_Listener<PointT<D, Scalar>> *tree_listener() { return NULL; }
+
+template <>
+inline Graph_Listener<Point> *tree_listener<2, double>() { return Planner::listener; }
+
+/****************************************************************************/
+
+                            /* Implementation */
+
+/****************************************************************************/
+
+/****************************************************************************/
+
+                            /* Planner Utils */
+
+/****************************************************************************/
+
+/**
+ * @brief Constructor with initial point.
+ *
+ * @param init_pt Initial Point.
+ * @return Planner Util object with init_pt.
+ */
+template <int D, typename Scalar>
+Planner_UtilsT<D, Scalar>::Planner_UtilsT(Pt *init_pt) {
+  assert(init_pt != NULL);
+
+  this->parents = counted_map<Pt*, Pt*>();
+  this->costs = counted_map<Pt*, double>();
+
+  this->parents[init_pt] = NULL;
+  this->costs[init_pt] = 0;
+}
+
+/**
+ * @brief Get the parent of a point.
+ *
+ * @param p A Point.
+ * @return A pointer to the parent of of p.
+ */
+template <int D, typename Scalar>
+PointT<D, Scalar>* Planner_UtilsT<D, Scalar>::get_parent(Pt *p) {
+  assert(p != NULL);
+  assert(this->parents.find(p) != this->parents.end());
+  return this->parents[p];
+}
+
+/**
+ * @brief Get the cost of a point from the initial point.
+ *
+ * @param p A Point.
+ * @return The cost of p.
+ */
+template <int D, typename Scalar>
+double Planner_UtilsT<D, Scalar>::get_cost(Pt *p) {
+  assert(p != NULL);
+  assert(this->costs.find(p) != this->costs.end());
+  return this->costs[p];
+}
+
+/**
+ * @brief Adds point with its info to Planner_Utils objects.
+ *
+ * @param p A Point.
+ * @param parent Parent of point p.
+ * @param cost cost of point p.
+ * @return Void.
+ */
+template <int D, typename Scalar>
+void Planner_UtilsT<D, Scalar>::add_point(Pt *p, Pt *parent, double cost) {
+  assert(p != NULL);
+  this->parents[p] = parent;
+  this->costs[p] = cost;
+}
+
+/**
+ * @brief Updates the parent of point p.
+ *
+ * @param p A Point.
+ * @param parent New parent.
+ * @return Void.
+ */
+template <int D, typename Scalar>
+void Planner_UtilsT<D, Scalar>::set_parent(Pt *p, Pt *parent) {
+  assert(p != NULL);
+  this->parents[p] = parent;
+}
+
+/**
+ * @brief Updates the cost of point p.
+ *
+ * @param p A Point.
+ * @param cost New cost.
+ * @return Void.
+ */
+template <int D, typename Scalar>
+void Planner_UtilsT<D, Scalar>::set_cost(Pt *p, double cost) {
+  assert(p != NULL);
+  this->costs[p] = cost;
+}
+
+/**
+ * @brief Forgets point p.
+ *
+ * @param p A Point.
+ * @return Void.
+ */
+template <int D, typename Scalar>
+void Planner_UtilsT<D, Scalar>::remove_point(Pt *p) {
+  assert(p != NULL);
+  this->parents.erase(p);
+  this->costs.erase(p);
+}
+
+
+
+/****************************************************************************/
+
+                              /* Plan Result */
+
+/****************************************************************************/
+
+/**
+ * @brief Constructor for a result that takes ownership of the tree.
+ *
+ * @param graph Explored tree, or NULL if it is owned elsewhere.
+ * @param start Starting Point, owned by the caller.
+ * @param goal Target Point, owned by the caller.
+ * @return Result with an empty path.
+ */
+template <int D, typename Scalar>
+PlanResultT<D, Scalar>::PlanResultT(Graph<Pt> *graph, Pt *start, Pt *goal) {
+  this->converged = false;
+  this->iterations = 0;
+  this->overshoot_ms = 0;
+  this->memory = {0, 0, 0};
+  this->graph = graph;
+  this->start = start;
+  this->goal = goal;
+}
+
+/**
+ * @brief Move constructor, other is left without a tree.
+ *
+ * @param other Result to take the path and the tree from.
+ * @return Result owning the tree of other.
+ */
+template <int D, typename Scalar>
+PlanResultT<D, Scalar>::PlanResultT(PlanResultT &&other)
+  : path(move(other.path)) {
+  this->converged = other.converged;
+  this->iterations = other.iterations;
+  this->overshoot_ms = other.overshoot_ms;
+  this->memory = other.memory;
+  this->graph = other.graph;
+  this->start = other.start;
+  this->goal = other.goal;
+  other.graph = NULL;
+}
+
+/**
+ * @brief Deletes the tree together with all of the points it owns.
+ */
+template <int D, typename Scalar>
+PlanResultT<D, Scalar>::~PlanResultT() {
+  this->release();
+}
+
+/**
+ * @brief Move assignment, the current tree is deleted and other is left
+ * without one.
+ *
+ * @param other Result to take the path and the tree from.
+ * @return This result.
+ */
+template <int D, typename Scalar>
+PlanResultT<D, Scalar>& PlanResultT<D, Scalar>::operator=(PlanResultT &&other) {
+  if (this == &other) { return *this; }
+  this->release();
+  this->path = move(other.path);
+  this->converged = other.converged;
+  this->iterations = other.iterations;
+  this->overshoot_ms = other.overshoot_ms;
+  this->memory = other.memory;
+  this->graph = other.graph;
+  this->start = other.start;
+  this->goal = other.goal;
+  other.graph = NULL;
+  return *this;
+}
+
+/**
+ * @brief Checks whether the result carries the tree it was planned on.
+ *
+ * @return False for results of the Replanner, which keeps its tree.
+ */
+template <int D, typename Scalar>
+bool PlanResultT<D, Scalar>::has_tree() const {
+  return this->graph != NULL;
+}
+
+/**
+ * @brief Read only view of the explored tree.
+ *
+ * @return The tree the path was found in.
+ */
+template <int D, typename Scalar>
+const Graph<PointT<D, Scalar>>& PlanResultT<D, Scalar>::tree() const {
+  assert(this->graph != NULL);
+  return *this->graph;
+}
+
+/**
+ * @brief Peak memory of the plan spread over the nodes of its tree, the
+ * figure to size planning hosts by.
+ *
+ * @return Peak bytes per tree node, or 0 if the result carries no tree.
+ */
+template <int D, typename Scalar>
+double PlanResultT<D, Scalar>::peak_bytes_per_node() const {
+  if (this->graph == NULL) { return 0; }
+  return (double) this->memory.peak_bytes / this->graph->num_vertices;
+}
+
+/**
+ * @brief Deletes the tree and its points, keeping start and goal.
+ *
+ * @return Void.
+ */
+template <int D, typename Scalar>
+void PlanResultT<D, Scalar>::release() {
+  if (this->graph == NULL) { return; }
+  for (auto &entry : this->graph->adj_list) {
+    Pt *p = entry.first;
+    if (p != this->start && p != this->goal) { delete p; }
+  }
+  delete this->graph;
+  this->graph = NULL;
+  this->path.clear();
+}
+
+
+
+/****************************************************************************/
+
+                            /* Helper Functions */
+
+/****************************************************************************/
+
+/**
+ * @brief Samples a random configuration that is free of obstacles, using the
+ * map's mix of uniform and obstacle-biased samplers.
+ *
+ * @param space A configuration space.
+ * @return A configuration inside the bounds of the space and free of obstacles.
+ */
+template <int D, typename Scalar>
+PointT<D, Scalar> *get_rand_config(Config_Space<D, Scalar> &space) {
+  return new PointT<D, Scalar>(space.sample());
+}
+
+/**
+ * @brief Returns a new point in the direction of the goal from start with at
+ * most distance EPSILON.
+ *
+ * @param start Point to step from.
+ * @param goal Point to step towards.
+ * @return goal itself if it is within EPSILON, otherwise a new point.
+ */
+template <int D, typename Scalar>
+PointT<D, Scalar>* new_config(PointT<D, Scalar> *start, PointT<D, Scalar> *goal) {
+  Scalar d = start->dist(*goal);
+  if(d <= EPSILON) {
+    return goal;
+  }
+
+  if constexpr (D == 2) {
+    double theta = start->angle(*goal);
+    double x = start->x + EPSILON * cos(theta);
+    double y = start->y + EPSILON * sin(theta);
+    return new PointT<D, Scalar>(x, y);
+  }
+  return new PointT<D, Scalar>(*start + (*goal - *start).scale(EPSILON / d));
+}
+
+/**
+ * @brief Tries to extend a branch from the tree to the goal by at most
+ * EPSILON
+ *
+ * @param graph Graph of entire explored space.
+ * @param tree Tree to extend from.
+ * @param parents Parent of every node in tree, extended with the new node.
+ * @param goal Goal point to extend to.
+ * @param space A configuration space.
+ * @return A point inside the dimensions of the map and free of obstacles.
+ */
+template <int D, typename Scalar>
+pair<PointT<D, Scalar>*, status_t> extend(Graph<PointT<D, Scalar>> &graph,
+                                          KDTreeT<D, Scalar> *tree,
+                                          counted_map<PointT<D, Scalar>*,
+                                                      PointT<D, Scalar>*> &parents,
+                                          PointT<D, Scalar> *goal,
+                                          Config_Space<D, Scalar> &space) {
+    TRACE_SCOPE("extend");
+    PointT<D, Scalar> *near_p = tree->nearest_neighbor(goal, Planner::nn_epsilon);
+    PointT<D, Scalar> *new_p = new_config(near_p, goal);
+    if (space.is_valid_path(*near_p, *new_p)) {
+        graph.add_edge(new_p, near_p);
+        parents[new_p] = near_p;
+        if (new_p == goal) { /* Equality test is on pointers */
+          return {goal, REACHED};
+        }
+        tree->insert_node(new_p); /* Only add new_p if it's not already there */
+        return {new_p, ADVANCED};
+    }
+    if(new_p != goal) { delete new_p; }
+    return {NULL, TRAPPED};
+}
+
+/**
+ * @brief Lays out a KD-tree grown by a planner once it has doubled, if that
+ * fits before the deadline. Otherwise the tree stays as it is, which only
+ * makes queries slower until the planner returns.
+ *
+ * @param tree KD-tree whose automatic relayout is off.
+ * @param deadline Time by which the planner has to return.
+ * @return Void.
+ */
+template <int D, typename Scalar>
+void maintain_tree(KDTreeT<D, Scalar> *tree, Deadline &deadline) {
+  if (tree->relayout_due() && deadline.has_time_for(tree->relayout_estimate())) {
+    tree->relayout();
+  }
+}
+
+/**
+ * @brief Pushes a change in the cost of p down to all of its descendants.
+ *
+ * @param graph Graph of entire explored space.
+ * @param p Point whose cost changed.
+ * @param utils Parents and costs of the tree.
+ * @return Void.
+ */
+template <int D, typename Scalar>
+void propagate_cost(Graph<PointT<D, Scalar>> &graph, PointT<D, Scalar> *p,
+                    Planner_UtilsT<D, Scalar> &utils) {
+  for (PointT<D, Scalar> *child : graph.get_neighbors(p)) {
+    if (utils.get_parent(child) != p) { continue; }
+    utils.set_cost(child, utils.get_cost(p) + p->dist(*child));
+    propagate_cost(graph, child, utils);
+  }
+}
+
+/**
+ * @brief Volume that samples are drawn from: the space, or once a path of
+ * cost c_best is known the part of it inside the informed ellipsoid.
+ *
+ * @param start Starting Point.
+ * @param goal Target Point.
+ * @param c_best Cost of the best path so far, DBL_MAX if none.
+ * @param space A configuration space.
+ * @return Volume sampled.
+ */
+template <int D, typename Scalar>
+double sampled_volume(PointT<D, Scalar> *start, PointT<D, Scalar> *goal, double c_best,
+                      const Config_Space<D, Scalar> &space) {
+  double space_volume = space.volume();
+  if (c_best == DBL_MAX) { return space_volume; }
+  double c_min = start->dist(*goal);
+  double a = c_best / 2;
+  double b = sqrt(max(c_best * c_best - c_min * c_min, 0.0)) / 2;
+  return min(space_volume, unit_ball_volume<D>() * a * pow(b, D - 1));
+}
+
+/**
+ * @brief Slack to allow when comparing a cost with a bound on it, since the
+ * cost of a path and the straight line distance that bounds it round
+ * differently. It grows with the cost and with the precision lost by Scalar.
+ *
+ * @param cost Cost being compared.
+ * @return Tolerance, never below POINT_EPSILON.
+ */
+template <typename Scalar>
+double cost_tolerance(double cost) {
+  return max((double) POINT_EPSILON,
+             fabs(cost) * numeric_limits<Scalar>::epsilon() * COST_TOLERANCE_ULPS);
+}
+
+/**
+ * @brief Radius within which a new node of an RRT* tree is rewired. It
+ * shrinks as (log n / n)^(1/d) so that a node meets O(log n) others, which
+ * keeps RRT* asymptotically optimal (Karaman and Frazzoli) while the cost
+ * of an iteration stops growing with the tree.
+ *
+ * @param num_nodes Number of nodes in the tree.
+ * @param volume Volume that samples are drawn from.
+ * @return Rewiring radius, at most SEARCH_RADIUS.
+ */
+template <int D>
+double rewire_radius(size_t num_nodes, double volume) {
+  if (num_nodes < 2) { return SEARCH_RADIUS; }
+  double gamma = REWIRE_GAMMA_MARGIN * 2 * pow(1 + 1.0 / D, 1.0 / D) *
+                 pow(volume / unit_ball_volume<D>(), 1.0 / D);
+  return min((double) SEARCH_RADIUS,
+             gamma * pow(log(num_nodes) / num_nodes, 1.0 / D));
+}
+
+/**
+ * @brief Tries to extend a branch from the tree to the goal by at most
+ * EPSILON and rewires the nearby nodes. Once a path of cost c_best is known,
+ * a new node whose cost to come plus straight line distance to target
+ * exceeds it could never shorten the path, so it is dropped before it is
+ * added or anything is rewired through it.
+ *
+ * @param graph Graph of entire explored space.
+ * @param tree Tree to extend from.
+ * @param goal Goal point to extend to.
+ * @param space A configuration space.
+ * @param radius Rewiring radius, see rewire_radius.
+ * @param target Point the tree is planning to, the other end of the path.
+ * @param c_best Cost of the best path so far, DBL_MAX if none.
+ * @return A point inside the dimensions of the map and free of obstacles.
+ */
+template <int D, typename Scalar>
+pair<PointT<D, Scalar>*, status_t> extend_rewired(Graph<PointT<D, Scalar>> &graph,
+                                                  KDTreeT<D, Scalar> *tree,
+                                                  PointT<D, Scalar> *goal,
+                                                  Planner_UtilsT<D, Scalar> &utils,
+                                                  Config_Space<D, Scalar> &space,
+                                                  double radius, PointT<D, Scalar> *target,
+                                                  double c_best) {
+    typedef PointT<D, Scalar> Pt;
+    TRACE_SCOPE("extend_rewired");
+    Pt *near_p = tree->nearest_neighbor(goal, Planner::nn_epsilon);
+    Pt *new_p = new_config(near_p, goal);
+    if (space.is_valid_path(*near_p, *new_p)) {
+      double min_cost = utils.get_cost(near_p) + near_p->dist(*new_p);
+      Pt *min_p = near_p;
+      unordered_set<Pt*> nearest = tree->points_in_radius(new_p, radius);
+
+      /* No parent can do better than the cheapest neighbor ignoring
+       * obstacles. Same bound as prune_tree, which would remove the node. */
+      double bound = DBL_MAX;
+      if (c_best != DBL_MAX) {
+        bound = c_best + cost_tolerance<Scalar>(c_best) - new_p->dist(*target);
+      }
+      double lower = min_cost;
+      vector<pair<double, Pt*>> candidates;
+      for (Pt *neighbor : nearest) {
+        double path_cost = utils.get_cost(neighbor) + neighbor->dist(*new_p);
+        if (path_cost < min_cost) { candidates.push_back({path_cost, neighbor}); }
+        lower = min(lower, path_cost);
+      }
+      if (lower > bound) {
+        if (new_p != goal) { delete new_p; }
+        return {NULL, TRAPPED};
+      }
+
+      /* The cheapest neighbor that sees new_p is its parent */
+      sort(candidates.begin(), candidates.end());
+      for (auto &candidate : candidates) {
+        if (space.is_valid_path(*candidate.second, *new_p)) {
+          min_p = candidate.second;
+          min_cost = candidate.first;
+          break;
+        }
+      }
+      if (min_cost > bound) {
+        if (new_p != goal) { delete new_p; }
+        return {NULL, TRAPPED};
+      }
+
+      tree->insert_node(new_p);
+      utils.add_point(new_p, min_p, min_cost);
+      graph.add_edge(min_p, new_p);
+
+      /* Check if all other neighbors have shorter path through new_p */
+      for (Pt *neighbor : nearest) {
+        if(neighbor == min_p) { continue; }
+        double path_cost = utils.get_cost(new_p) + new_p->dist(*neighbor);
+        if (path_cost < utils.get_cost(neighbor) &&
+            space.is_valid_path(*neighbor, *new_p)) {
+          Pt* parent = utils.get_parent(neighbor);
+          if (parent != NULL) { graph.remove_edge(parent, neighbor); }
+          graph.add_edge(new_p, neighbor);
+          utils.set_parent(neighbor, new_p);
+          utils.set_cost(neighbor, path_cost);
+          propagate_cost(graph, neighbor, utils);
+        }
+      }
+
+      if (new_p == goal) { /* Equality test is on pointers */
+        return {goal, REACHED};
+      }
+      return {new_p, ADVANCED};
+    }
+    if(new_p != goal) { delete new_p; }
+    return {NULL, TRAPPED};
+}
+
+/**
+ * @brief Extends a branch from the tree straight towards the goal in steps
+ * of EPSILON for as long as the way is free. The nearest node is found once
+ * and the longest free prefix of the ray from it is found by bisection over
+ * the number of steps, checking whole prefixes at a time, so a free ray
+ * costs a single collision check. The nodes along the prefix are then added
+ * together.
+ *
+ * @param graph Graph of entire explored space.
+ * @param tree Tree to extend from.
+ * @param parents Parent of every node in tree.
+ * @param goal Goal point to extend to.
+ * @param space A configuration space.
+ * @return The goal if it was reached, otherwise TRAPPED.
+ */
+template <int D, typename Scalar>
+pair<PointT<D, Scalar>*, status_t> connect(Graph<PointT<D, Scalar>> &graph,
+                                           KDTreeT<D, Scalar> *tree,
+                                           counted_map<PointT<D, Scalar>*,
+                                                       PointT<D, Scalar>*> &parents,
+                                           PointT<D, Scalar> *goal,
+                                           Config_Space<D, Scalar> &space) {
+    typedef PointT<D, Scalar> Pt;
+    TRACE_SCOPE("connect");
+    Pt *near_p = tree->nearest_neighbor(goal, Planner::nn_epsilon);
+    Pt ray = *goal - *near_p;
+    double d = near_p->dist(*goal);
+    int num_steps = max(1, (int) ceil(d / EPSILON));
+    Pt step = (d > 0) ? ray.scale(EPSILON / d) : Pt();
+
+    /* Step k lands at near_p + k * step, except the last lands on goal */
+    int free_steps = num_steps;
+    if (!space.is_valid_path(*near_p, *goal)) {
+      int lo = 0;             /* Prefix known to be free */
+      int hi = num_steps;     /* Prefix known to collide */
+      while (hi - lo > 1) {
+        int mid = lo + (hi - lo) / 2;
+        if (space.is_valid_path(*near_p, *near_p + step.scale(mid))) {
+          lo = mid;
+        } else {
+          hi = mid;
+        }
+      }
+      free_steps = lo;
+    }
+
+    vector<Pt*> added;
+    Pt *prev = near_p;
+    for (int k = 1; k <= free_steps; k++) {
+      Pt *new_p = (k == num_steps) ? goal : new Pt(*near_p + step.scale(k));
+      graph.add_edge(new_p, prev);
+      parents[new_p] = prev;
+      if (new_p != goal) { added.push_back(new_p); }
+      prev = new_p;
+    }
+    tree->insert_nodes(added);
+
+    if (free_steps == num_steps) { return {goal, REACHED}; }
+    return {NULL, TRAPPED};
+}
+
+/**
+ * @brief Draws a point uniformly from the unit ball. The planar case keeps
+ * to polar coordinates, higher dimensions scale a Gaussian direction.
+ *
+ * @return Point inside the unit ball.
+ */
+template <int D, typename Scalar>
+PointT<D, Scalar> sample_unit_ball() {
+  PointT<D, Scalar> p;
+  if constexpr (D == 2) {
+    double r = sqrt(random_unit());
+    double phi = 2 * M_PI * random_unit();
+    p[0] = r * cos(phi);
+    p[1] = r * sin(phi);
+    return p;
+  }
+  double norm = 0;
+  while (norm == 0) {
+    for (int i = 0; i < D; i++) {
+      /* Box-Muller, the first factor is never infinite */
+      double u = random_unit_open();
+      double v = random_unit();
+      p[i] = sqrt(-2 * log(u)) * cos(2 * M_PI * v);
+    }
+    norm = sqrt(p.dot(p));
+  }
+  double r = pow(random_unit(), 1.0 / D);
+  return p.scale(r / norm);
+}
+
+/**
+ * @brief Samples a free point inside the ellipsoid of all points that could
+ * lie on a path from start to goal shorter than c_best. Falls back to
+ * sampling the whole space while there is no solution or the ellipsoid is
+ * larger than it, in which case samples outside the ellipsoid are rejected
+ * before the caller spends any neighbor queries or collision checks on them.
+ *
+ * @param start Starting Point.
+ * @param goal Target Point.
+ * @param c_best Cost of the best solution so far.
+ * @param space A configuration space.
+ * @return A point inside the ellipsoid and free of obstacles.
+ */
+template <int D, typename Scalar>
+PointT<D, Scalar> *get_informed_config(PointT<D, Scalar> *start, PointT<D, Scalar> *goal,
+                                       double c_best, Config_Space<D, Scalar> &space) {
+  typedef PointT<D, Scalar> Pt;
+  double c_min = start->dist(*goal);
+  double a = c_best / 2;
+  double b = sqrt(max(c_best * c_best - c_min * c_min, 0.0)) / 2;
+  if (c_best == DBL_MAX) {
+    return get_rand_config(space);
+  }
+  if (unit_ball_volume<D>() * a * pow(b, D - 1) >= space.volume()) {
+    while (true) {
+      Pt p = space.sample();
+      if (start->dist(p) + p.dist(*goal) <= c_best) { return new Pt(p); }
+    }
+  }
+
+  /* The ellipsoid's major axis runs along u, the unit vector from start to
+   * goal. In the plane that is a rotation, in more dimensions the reflection
+   * that swaps the first axis with u, since the ellipsoid is symmetric. */
+  Pt u;
+  u[0] = 1;
+  if (c_min > 0) { u = (*goal - *start).scale(1 / c_min); }
+  Pt v = u;
+  v[0] -= 1;
+  double vv = v.dot(v);
+  Pt center = (*start + *goal).scale(0.5);
+  while (true) {
+    /* Uniform point in the unit ball stretched onto the ellipsoid */
+    Pt x = sample_unit_ball<D, Scalar>();
+    x[0] *= a;
+    for (int i = 1; i < D; i++) { x[i] *= b; }
+    Pt p;
+    if constexpr (D == 2) {
+      p = Pt(center.x + x.x * u.x - x.y * u.y, center.y + x.x * u.y + x.y * u.x);
+    } else {
+      p = center + x;
+      if (vv > 0) { p = p - v.scale(2 * v.dot(x) / vv); }
+    }
+    if (space.in_bounds(p) && space.is_freespace(p)) {
+      return new Pt(p);
+    }
+  }
+}
+
+/**
+ * @brief Removes every node that cannot lie on a path shorter than c_best,
+ * i.e. whose cost to come plus straight line distance to goal exceeds it,
+ * along with its subtree. Costs only grow down the tree, so the subtree of a
+ * removed node could not be kept either. Orphans no longer reachable from
+ * start go as well. The nodes of the best path to goal are always kept, so
+ * rounding in their costs can never cut it. The KD-tree is rebuilt from the
+ * survivors in place.
+ *
+ * @param graph Graph of entire explored space.
+ * @param tree KD-tree over the nodes, rebuilt over the remaining ones.
+ * @param utils Parents and costs of the tree.
+ * @param start Root of the tree.
+ * @param goal Target Point.
+ * @param c_best Cost of the best solution so far.
+ * @return The same KD-tree.
+ */
+template <int D, typename Scalar>
+KDTreeT<D, Scalar> *prune_tree(Graph<PointT<D, Scalar>> &graph, KDTreeT<D, Scalar> *tree,
+                               Planner_UtilsT<D, Scalar> &utils, PointT<D, Scalar> *start,
+                               PointT<D, Scalar> *goal, double c_best) {
+  typedef PointT<D, Scalar> Pt;
+  double bound = c_best + cost_tolerance<Scalar>(c_best);
+
+  /* The best path stays whatever rounding says about its nodes */
+  unordered_set<Pt*> best_path;
+  auto goal_cost = utils.costs.find(goal);
+  if (goal_cost != utils.costs.end() && goal_cost->second != DBL_MAX) {
+    for (Pt *p = goal; p != NULL; p = utils.get_parent(p)) { best_path.insert(p); }
+  }
+
+  vector<Pt*> kept = {start};
+  unordered_set<Pt*> kept_set = {start};
+  for (size_t i = 0; i < kept.size(); i++) {
+    Pt *p = kept[i];
+    for (Pt *child : graph.get_neighbors(p)) {
+      if (utils.get_parent(child) != p) { continue; }
+      double f = utils.get_cost(child) + child->dist(*goal);
+      if (child == goal || f <= bound || best_path.find(child) != best_path.end()) {
+        kept.push_back(child);
+        kept_set.insert(child);
+      }
+    }
+  }
+
+  /* Subtrees of removed nodes are unreachable, so they go with them */
+  vector<Pt*> removed;
+  for (auto entry : utils.parents) {
+    if (kept_set.find(entry.first) == kept_set.end()) {
+      removed.push_back(entry.first);
+    }
+  }
+  for (Pt *p : removed) {
+    graph.remove_vertex(p);
+    utils.remove_point(p);
+    if (p != start && p != goal) { delete p; } /* Owned by the caller */
+  }
+
+  tree->rebuild(kept);
+  return tree;
+}
+
+/**
+ * @brief Follows parent pointers from p back to the root of its tree.
+ *
+ * @param parents Parent of every node in the tree, NULL for the root.
+ * @param p Last Point of the path.
+ * @return Path from the root to p.
+ */
+template <int D, typename Scalar>
+vector<PointT<D, Scalar>*> trace_path(counted_map<PointT<D, Scalar>*,
+                                                  PointT<D, Scalar>*> &parents,
+                                      PointT<D, Scalar> *p) {
+  vector<PointT<D, Scalar>*> path;
+  for (; p != NULL; p = parents[p]) {
+    path.push_back(p);
+  }
+  reverse(path.begin(), path.end());
+  return path;
+}
+
+/**
+ * @brief RRT-Connect planner shared by the iteration and deadline bounded
+ * APIs.
+ *
+ * @param start Starting Point.
+ * @param goal Target Point.
+ * @param space A configuration space.
+ * @param num_iterations Maximum number of samples to draw.
+ * @param deadline Time by which to give up.
+ * @return Path to the target, or to the closest approach if not converged.
+ */
+template <int D, typename Scalar>
+PlanResultT<D, Scalar> rrt_connect(PointT<D, Scalar> *start, PointT<D, Scalar> *goal,
+                                   Config_Space<D, Scalar> &space, int num_iterations,
+                                   Deadline &deadline) {
+  typedef PointT<D, Scalar> Pt;
+  TRACE_SCOPE("RRT_connect");
+  KDTreeT<D, Scalar> *treeA = new KDTreeT<D, Scalar>(start);
+  KDTreeT<D, Scalar> *treeB = new KDTreeT<D, Scalar>(goal);
+  KDTreeT<D, Scalar> *start_tree = treeA;
+  treeA->auto_relayout = false;
+  treeB->auto_relayout = false;
+  counted_map<Pt*, Pt*> parentsA = {{start, NULL}};
+  counted_map<Pt*, Pt*> parentsB = {{goal, NULL}};
+  Graph<Pt> *graph = new Graph<Pt>(start);
+  graph->watch(tree_listener<D, Scalar>(), start);
+  PlanResultT<D, Scalar> result(graph, start, goal);
+  pair<Pt*, status_t> p_status;
+
+  int i = 0;
+  for (; i < num_iterations && !deadline.expired(); i++) {
+      maintain_tree(treeA, deadline);
+      maintain_tree(treeB, deadline);
+      Pt *rand_config = get_rand_config(space);
+
+      p_status = extend(*graph, treeA, parentsA, rand_config, space);
+      if (p_status.second != REACHED) { delete rand_config; }
+      if (p_status.second != TRAPPED) {
+          Pt *join = p_status.first;
+          p_status = connect(*graph, treeB, parentsB, join, space);
+          if (p_status.second == REACHED) {
+              /* join is in both trees, so each half ends there */
+              if (treeA != start_tree) { swap(parentsA, parentsB); }
+              result.path = trace_path(parentsA, join);
+              vector<Pt*> to_goal = trace_path(parentsB, join);
+              result.path.insert(result.path.end(), to_goal.rbegin() + 1, to_goal.rend());
+              result.converged = true;
+              i++;
+              break;
+          }
+          swap(treeA, treeB); /* built in swap function */
+          swap(parentsA, parentsB);
+      }
+  }
+
+  if (!result.converged) {
+    if (treeA != start_tree) { swap(parentsA, parentsB); }
+    result.path = trace_path(parentsA, start_tree->nearest_neighbor(goal));
+  }
+  delete treeA;
+  delete treeB;
+  result.iterations = i;
+  result.overshoot_ms = deadline.overshoot_ms();
+  return result;
+}
+
+/**
+ * @brief Checks whether the goal is in the tree and connected to its root.
+ * Nodes cut off from the root by an obstacle have infinite cost.
+ *
+ * @param t An RRT* tree.
+ * @return True if there is a path to the goal.
+ */
+template <int D, typename Scalar>
+bool is_reached(RRT_Star_TreeT<D, Scalar> &t) {
+  auto goal_cost = t.utils.costs.find(t.goal);
+  return goal_cost != t.utils.costs.end() && goal_cost->second != DBL_MAX;
+}
+
+/**
+ * @brief Finds the node connected to the root that is closest to the goal.
+ *
+ * @param t An RRT* tree.
+ * @return Closest approach to the goal.
+ */
+template <int D, typename Scalar>
+PointT<D, Scalar> *closest_reachable(RRT_Star_TreeT<D, Scalar> &t) {
+  PointT<D, Scalar> *closest = t.root;
+  for (auto entry : t.utils.costs) {
+    if (entry.second != DBL_MAX &&
+        entry.first->dist(*t.goal) < closest->dist(*t.goal)) {
+      closest = entry.first;
+    }
+  }
+  return closest;
+}
+
+/**
+ * @brief Grows an RRT* tree. An anytime plan keeps refining after the goal
+ * is first reached, sampling only from the ellipsoid of points that can
+ * still shorten the path and pruning nodes outside of it.
+ *
+ * @param t Tree to grow.
+ * @param space A configuration space.
+ * @param num_iterations Maximum number of samples to draw.
+ * @param deadline Time by which to return the best path so far.
+ * @param anytime Whether to keep refining after the first solution.
+ * @param curve If not NULL, filled with the best cost after each improvement.
+ * @return Path to the target, or to the closest approach if not converged.
+ * The result carries no tree, the tree stays in t.
+ */
+template <int D, typename Scalar>
+PlanResultT<D, Scalar> grow_rrt_star(RRT_Star_TreeT<D, Scalar> &t,
+                                     Config_Space<D, Scalar> &space, int num_iterations,
+                                     Deadline &deadline, bool anytime,
+                                     vector<Cost_Sample> *curve) {
+  typedef PointT<D, Scalar> Pt;
+  auto start_time = chrono::steady_clock::now();
+  if (curve != NULL) { curve->clear(); }
+
+  int i = 0;
+  for (; i < num_iterations && !deadline.expired(); i++) {
+      double rand_num = random_unit();
+      Pt *rand_config;
+      bool goal_in_tree = t.utils.costs.find(t.goal) != t.utils.costs.end();
+      if(!goal_in_tree && rand_num < GOAL_BIAS) {
+        rand_config = t.goal;
+      } else {
+        rand_config = get_informed_config(t.root, t.goal, t.c_best, space);
+      }
+      double radius = rewire_radius<D>(t.utils.parents.size(),
+                                       sampled_volume(t.root, t.goal, t.c_best, space));
+      pair<Pt*, status_t> p_status = extend_rewired(t.graph, t.tree, rand_config,
+                                                    t.utils, space, radius,
+                                                    t.goal, t.c_best);
+      if (p_status.second != REACHED && rand_config != t.goal) { delete rand_config; }
+      maintain_tree(t.tree, deadline);
+      if (!t.solved && is_reached(t)) {
+        t.solved = true;
+        if (!anytime) { i++; break; }
+      }
+      if (!t.solved) { continue; }
+
+      if (t.utils.get_cost(t.goal) < t.c_best) {
+        t.c_best = t.utils.get_cost(t.goal);
+        if (curve != NULL) {
+          chrono::duration<double, milli> elapsed = chrono::steady_clock::now() - start_time;
+          curve->push_back({elapsed.count(), i, t.c_best});
+        }
+      }
+
+      /* Nodes added since the last prune may already be out of bounds, so
+       * prune as the tree grows too, which keeps the cost amortized. A prune
+       * is skipped, not cut short, when it would not fit before the deadline. */
+      size_t num_nodes = t.utils.parents.size();
+      auto prune_estimate = chrono::nanoseconds((long long) (t.prune_ns_per_node * num_nodes));
+      if ((t.c_best < t.c_pruned * (1 - PRUNE_IMPROVEMENT) ||
+           num_nodes > t.pruned_size * (1 + PRUNE_GROWTH)) &&
+          deadline.has_time_for(prune_estimate)) {
+        auto prune_start = chrono::steady_clock::now();
+        t.tree = prune_tree(t.graph, t.tree, t.utils, t.root, t.goal, t.c_best);
+        chrono::duration<double, nano> elapsed = chrono::steady_clock::now() - prune_start;
+        t.prune_ns_per_node = elapsed.count() / num_nodes;
+        t.c_pruned = t.c_best;
+        t.pruned_size = t.utils.parents.size();
+      }
+  }
+
+  Pt *closest = t.solved ? t.goal : closest_reachable(t);
+  PlanResultT<D, Scalar> result(NULL, t.root, t.goal);
+  result.path = trace_path(t.utils.parents, closest);
+  result.converged = t.solved;
+  result.iterations = i;
+  return result;
+}
+
+/**
+ * @brief RRT-star planner shared by the iteration and deadline bounded APIs.
+ *
+ * @param start Starting Point.
+ * @param goal Target Point.
+ * @param space A configuration space.
+ * @param num_iterations Maximum number of samples to draw.
+ * @param deadline Time by which to return the best path so far.
+ * @param anytime Whether to keep refining after the first solution.
+ * @param curve If not NULL, filled with the best cost after each improvement.
+ * @return Path to the target, or to the closest approach if not converged.
+ */
+template <int D, typename Scalar>
+PlanResultT<D, Scalar> rrt_star(PointT<D, Scalar> *start, PointT<D, Scalar> *goal,
+                                Config_Space<D, Scalar> &space, int num_iterations,
+                                Deadline &deadline, bool anytime,
+                                vector<Cost_Sample> *curve) {
+  TRACE_SCOPE("RRT_star");
+  RRT_Star_TreeT<D, Scalar> t(start, goal);
+  PlanResultT<D, Scalar> grown = grow_rrt_star(t, space, num_iterations, deadline,
+                                               anytime, curve);
+
+  /* Hand the tree's storage over to the result instead of copying it */
+  PlanResultT<D, Scalar> result(new Graph<PointT<D, Scalar>>(move(t.graph)), start, goal);
+  result.path = move(grown.path);
+  result.converged = grown.converged;
+  result.iterations = grown.iterations;
+  result.overshoot_ms = deadline.overshoot_ms();
+  return result;
+}
+
+/****************************************************************************/
+
+                           /* Bidirectional RRT* */
+
+/****************************************************************************/
+
+/* One of the two trees of a bidirectional RRT* search. Both share a Graph,
+ * which never holds an edge between them while the search runs, so cost
+ * propagation stays within a tree. */
+template <int D, typename Scalar>
+struct Half_Tree {
+  PointT<D, Scalar> *root;
+  KDTreeT<D, Scalar> *tree;
+  Planner_UtilsT<D, Scalar> utils;
+
+  Half_Tree(PointT<D, Scalar> *root)
+    : root(root), tree(new KDTreeT<D, Scalar>(root)), utils(root) {
+    this->tree->auto_relayout = false;
+  }
 };
 
+/**
+ * @brief Grows a tree straight towards target with rewired extensions until
+ * it lands on target or is trapped. The tree gets its own copy of target so
+ * that both trees can hold a node there.
+ *
+ * @param graph Graph of entire explored space.
+ * @param half Tree to grow.
+ * @param target Point to grow towards, a node of the other tree.
+ * @param space A configuration space.
+ * @param volume Volume that samples are drawn from, see sampled_volume.
+ * @return Node of half at the position of target, or NULL if trapped.
+ */
+template <int D, typename Scalar>
+PointT<D, Scalar> *connect_rewired(Graph<PointT<D, Scalar>> &graph, Half_Tree<D, Scalar> &half,
+                                   PointT<D, Scalar> *target, Config_Space<D, Scalar> &space,
+                                   double volume) {
+  PointT<D, Scalar> *copy = new PointT<D, Scalar>(*target);
+  while (true) {
+    double radius = rewire_radius<D>(half.utils.parents.size(), volume);
+    pair<PointT<D, Scalar>*, status_t> p_status = extend_rewired(graph, half.tree, copy,
+                                                                 half.utils, space, radius,
+                                                                 copy, DBL_MAX);
+    if (p_status.second == REACHED) { return copy; }
+    if (p_status.second == TRAPPED) {
+      delete copy;
+      return NULL;
+    }
+  }
+}
+
+/**
+ * @brief Finds the node of a tree near p through which p can be reached most
+ * cheaply from the tree's root along a straight, collision free edge.
+ *
+ * @param half Tree to search.
+ * @param p Point to reach, a node of the other tree.
+ * @param space A configuration space.
+ * @return Node of half, or NULL if no node within SEARCH_RADIUS sees p.
+ */
+template <int D, typename Scalar>
+PointT<D, Scalar> *cheapest_neighbor(Half_Tree<D, Scalar> &half, PointT<D, Scalar> *p,
+                                     Config_Space<D, Scalar> &space) {
+  vector<pair<double, PointT<D, Scalar>*>> candidates;
+  for (PointT<D, Scalar> *q : half.tree->points_in_radius(p, SEARCH_RADIUS)) {
+    candidates.push_back({half.utils.get_cost(q) + q->dist(*p), q});
+  }
+  sort(candidates.begin(), candidates.end());
+  for (auto &candidate : candidates) {
+    if (space.is_valid_path(*candidate.second, *p)) { return candidate.second; }
+  }
+  return NULL;
+}
+
+/**
+ * @brief Cost of the path from start to goal through a bridge between the
+ * two trees.
+ *
+ * @param from_start Tree rooted at start.
+ * @param from_goal Tree rooted at goal.
+ * @param bridge Node of from_start and node of from_goal that see each other.
+ * @return Cost of the path through the bridge.
+ */
+template <int D, typename Scalar>
+double bridge_cost(Half_Tree<D, Scalar> &from_start, Half_Tree<D, Scalar> &from_goal,
+                   pair<PointT<D, Scalar>*, PointT<D, Scalar>*> bridge) {
+  return from_start.utils.get_cost(bridge.first) + bridge.first->dist(*bridge.second) +
+         from_goal.utils.get_cost(bridge.second);
+}
+
+/**
+ * @brief Bidirectional RRT* (RRT*-Connect). Grows rewired trees from start
+ * and goal, alternating between them: each sample extends one tree, then the
+ * new node tries to join the other tree. Until the trees first meet, the
+ * other tree grows straight towards the new node like in RRT-Connect. After
+ * that the new node is joined to its cheapest visible neighbor in the other
+ * tree, without growing it, and samples are drawn from the informed ellipsoid.
+ *
+ * Every join is kept as a bridge. Rewiring only ever lowers costs, so the
+ * best bridge is re-evaluated each iteration, and all bridges are compared
+ * once more at the end in case an older one overtook it.
+ *
+ * @param start Starting Point.
+ * @param goal Target Point.
+ * @param space A configuration space.
+ * @param num_iterations Maximum number of samples to draw.
+ * @param deadline Time by which to return the best path so far.
+ * @param curve If not NULL, filled with the best cost after each improvement.
+ * @return Best path to the target, or to the closest approach if the trees
+ * never met.
+ */
+template <int D, typename Scalar>
+PlanResultT<D, Scalar> rrt_star_connect(PointT<D, Scalar> *start, PointT<D, Scalar> *goal,
+                                        Config_Space<D, Scalar> &space, int num_iterations,
+                                        Deadline &deadline, vector<Cost_Sample> *curve) {
+  typedef PointT<D, Scalar> Pt;
+  TRACE_SCOPE("RRT_star_connect");
+  auto start_time = chrono::steady_clock::now();
+  if (curve != NULL) { curve->clear(); }
+
+  Graph<Pt> *graph = new Graph<Pt>(start);
+  graph->watch(tree_listener<D, Scalar>(), start);
+  PlanResultT<D, Scalar> result(graph, start, goal);
+
+  Half_Tree<D, Scalar> from_start(start);
+  Half_Tree<D, Scalar> from_goal(goal);
+  Half_Tree<D, Scalar> *A = &from_start;
+  Half_Tree<D, Scalar> *B = &from_goal;
+
+  vector<pair<Pt*, Pt*>> bridges; /* Node from start, node from goal */
+  int best = -1;
+  double c_best = DBL_MAX;
+
+  int i = 0;
+  for (; i < num_iterations && !deadline.expired(); i++) {
+      maintain_tree(from_start.tree, deadline);
+      maintain_tree(from_goal.tree, deadline);
+      Pt *rand_config = get_informed_config(start, goal, c_best, space);
+      double volume = sampled_volume(start, goal, c_best, space);
+      double radius = rewire_radius<D>(A->utils.parents.size(), volume);
+      Pt *target = (A == &from_start) ? goal : start;
+      pair<Pt*, status_t> p_status = extend_rewired(*graph, A->tree, rand_config,
+                                                    A->utils, space, radius,
+                                                    target, c_best);
+      if (p_status.second != REACHED) { delete rand_config; }
+
+      double cost = (best >= 0) ? bridge_cost(from_start, from_goal, bridges[best]) : DBL_MAX;
+      if (p_status.second != TRAPPED) {
+          Pt *new_p = p_status.first;
+          Pt *join = (best >= 0) ? cheapest_neighbor(*B, new_p, space)
+                                 : connect_rewired(*graph, *B, new_p, space, volume);
+          if (join != NULL) {
+              bridges.push_back((A == &from_start) ? make_pair(new_p, join)
+                                                   : make_pair(join, new_p));
+              double new_cost = bridge_cost(from_start, from_goal, bridges.back());
+              if (new_cost < cost) {
+                best = bridges.size() - 1;
+                cost = new_cost;
+              }
+          }
+      }
+      swap(A, B);
+
+      if (cost < c_best) {
+        c_best = cost;
+        if (curve != NULL) {
+          chrono::duration<double, milli> elapsed = chrono::steady_clock::now() - start_time;
+          curve->push_back({elapsed.count(), i, c_best});
+        }
+      }
+  }
+
+  for (size_t k = 0; k < bridges.size(); k++) {
+    double cost = bridge_cost(from_start, from_goal, bridges[k]);
+    if (cost < c_best) {
+      c_best = cost;
+      best = k;
+    }
+  }
+  if (curve != NULL && !curve->empty() && c_best < curve->back().cost) {
+    chrono::duration<double, milli> elapsed = chrono::steady_clock::now() - start_time;
+    curve->push_back({elapsed.count(), i, c_best});
+  }
+
+  if (best >= 0) {
+    pair<Pt*, Pt*> bridge = bridges[best];
+    graph->add_edge(bridge.first, bridge.second);
+    result.path = trace_path(from_start.utils.parents, bridge.first);
+    vector<Pt*> to_goal = trace_path(from_goal.utils.parents, bridge.second);
+    auto first = to_goal.rbegin();
+    if (*bridge.first == *bridge.second) { first++; } /* Copy of the same point */
+    result.path.insert(result.path.end(), first, to_goal.rend());
+    result.converged = true;
+  } else {
+    result.path = trace_path(from_start.utils.parents,
+                             from_start.tree->nearest_neighbor(goal));
+  }
+  delete from_start.tree;
+  delete from_goal.tree;
+  result.iterations = i;
+  result.overshoot_ms = deadline.overshoot_ms();
+  return result;
+}
+
+/****************************************************************************/
+
+                              /* RRT* Tree */
+
+/****************************************************************************/
+
+/**
+ * @brief Constructor for a tree containing just the root.
+ *
+ * @param root Root of the tree.
+ * @param goal Target Point.
+ * @return RRT* tree with no solution yet.
+ */
+template <int D, typename Scalar>
+RRT_Star_TreeT<D, Scalar>::RRT_Star_TreeT(Pt *root, Pt *goal)
+  : graph(root), utils(root) {
+  this->root = root;
+  this->goal = goal;
+  this->tree = new KDTreeT<D, Scalar>(root);
+  this->tree->auto_relayout = false; /* Laid out by grow_rrt_star */
+  this->solved = false;
+  this->c_best = DBL_MAX;
+  this->c_pruned = DBL_MAX;
+  this->pruned_size = 0;
+  this->prune_ns_per_node = PRUNE_NS_PER_NODE;
+  this->max_edge = SEARCH_RADIUS;
+  this->graph.watch(tree_listener<D, Scalar>(), root);
+}
+
+/* Points in the tree are handed out in results, so only the index goes */
+template <int D, typename Scalar>
+RRT_Star_TreeT<D, Scalar>::~RRT_Star_TreeT() {
+  delete this->tree;
+}
+
+/****************************************************************************/
+
+                          /* Templated API */
+
+/****************************************************************************/
+
+/**
+ * @brief RRT-Connect planner over a configuration space that returns by the
+ * given deadline.
+ *
+ * @param start Starting configuration.
+ * @param goal Target configuration.
+ * @param space A configuration space.
+ * @param deadline Time on the monotonic clock to return by.
+ * @return Path to the target if found in time, otherwise the path to the node
+ * closest to the target.
+ */
+template <int D, typename Scalar>
+PlanResultT<D, Scalar> Planner::RRT_connect(PointT<D, Scalar> *start, PointT<D, Scalar> *goal,
+                                            Config_Space<D, Scalar> &space,
+                                            chrono::steady_clock::time_point deadline) {
+  Deadline d(deadline);
+  Memory_Scope memory;
+  PlanResultT<D, Scalar> result = rrt_connect(start, goal, space, INT_MAX, d);
+  result.memory = memory.usage();
+  return result;
+}
+
+/**
+ * @brief Anytime RRT-star planner over a configuration space that refines
+ * its path until the given deadline.
+ *
+ * @param start Starting configuration.
+ * @param goal Target configuration.
+ * @param space A configuration space.
+ * @param deadline Time on the monotonic clock to return by.
+ * @return Best path to the target found in time, otherwise the path to the
+ * node closest to the target.
+ */
+template <int D, typename Scalar>
+PlanResultT<D, Scalar> Planner::RRT_star(PointT<D, Scalar> *start, PointT<D, Scalar> *goal,
+                                         Config_Space<D, Scalar> &space,
+                                         chrono::steady_clock::time_point deadline) {
+  Deadline d(deadline);
+  Memory_Scope memory;
+  PlanResultT<D, Scalar> result = rrt_star(start, goal, space, INT_MAX, d, true, NULL);
+  result.memory = memory.usage();
+  return result;
+}
+
+/**
+ * @brief Anytime Informed RRT* planner over a configuration space. Keeps
+ * refining the tree for the full iteration budget after the goal is first
+ * reached.
+ *
+ * @param start Starting configuration.
+ * @param goal Target configuration.
+ * @param space A configuration space.
+ * @param num_iterations Number of samples to draw.
+ * @param curve Filled with the best cost after each improvement.
+ * @return Path to the target, or to the closest approach if not converged,
+ * and the tree it was found in.
+ */
+template <int D, typename Scalar>
+PlanResultT<D, Scalar> Planner::RRT_star_informed(PointT<D, Scalar> *start,
+                                                  PointT<D, Scalar> *goal,
+                                                  Config_Space<D, Scalar> &space,
+                                                  int num_iterations,
+                                                  vector<Cost_Sample> &curve) {
+  Deadline never;
+  Memory_Scope memory;
+  PlanResultT<D, Scalar> result = rrt_star(start, goal, space, num_iterations, never, true,
+                                           &curve);
+  result.memory = memory.usage();
+  return result;
+}
+
+/**
+ * @brief Anytime bidirectional RRT* planner over a configuration space that
+ * refines its path until the given deadline.
+ *
+ * @param start Starting configuration.
+ * @param goal Target configuration.
+ * @param space A configuration space.
+ * @param deadline Time on the monotonic clock to return by.
+ * @return Best path to the target found in time, otherwise the path to the
+ * node closest to the target.
+ */
+template <int D, typename Scalar>
+PlanResultT<D, Scalar> Planner::RRT_star_connect(PointT<D, Scalar> *start,
+                                                 PointT<D, Scalar> *goal,
+                                                 Config_Space<D, Scalar> &space,
+                                                 chrono::steady_clock::time_point deadline) {
+  Deadline d(deadline);
+  Memory_Scope memory;
+  PlanResultT<D, Scalar> result = rrt_star_connect(start, goal, space, INT_MAX, d, NULL);
+  result.memory = memory.usage();
+  return result;
+}
+
 #endif /* __PLANNER_H */
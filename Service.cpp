@@ -0,0 +1,434 @@
+/**
+ *  @file Service.cpp
+ *  @brief Implements the planning service defined in Service.h
+ *
+ *  @author Shashank Ojha (shashano)
+ *  @author Serris Lew (snlew)
+ *  @author David Bick (dbick)
+ *  @bug No known bugs.
+ */
+
+#include <cassert>
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "utils/Random.h"
+
+#include "Service.h"
+#include "Planner.h"
+
+using namespace std;
+
+/****************************************************************************/
+
+                            /* Socket Helpers */
+
+/****************************************************************************/
+
+/**
+ * @brief Reads exactly len bytes, retrying short and interrupted reads.
+ *
+ * @param fd File descriptor to read from.
+ * @param buf Buffer of at least len bytes.
+ * @param len Number of bytes to read.
+ * @return True if all bytes were read and false on error or end of file.
+ */
+bool read_full(int fd, void *buf, size_t len) {
+  char *p = (char *) buf;
+  while (len > 0) {
+    ssize_t n = read(fd, p, len);
+    if (n < 0 && errno == EINTR) { continue; }
+    if (n <= 0) { return false; }
+    p += n;
+    len -= n;
+  }
+  return true;
+}
+
+/**
+ * @brief Writes exactly len bytes, retrying short and interrupted writes.
+ *
+ * @param fd File descriptor to write to.
+ * @param buf Buffer of len bytes.
+ * @param len Number of bytes to write.
+ * @return True if all bytes were written and false on error.
+ */
+bool write_full(int fd, const void *buf, size_t len) {
+  const char *p = (const char *) buf;
+  while (len > 0) {
+    ssize_t n = write(fd, p, len);
+    if (n < 0 && errno == EINTR) { continue; }
+    if (n <= 0) { return false; }
+    p += n;
+    len -= n;
+  }
+  return true;
+}
+
+/**
+ * @brief Fills in the address of a Unix domain socket.
+ *
+ * @param socket_path Path of the socket file.
+ * @return Address of the socket.
+ */
+sockaddr_un socket_address(const string &socket_path) {
+  sockaddr_un addr;
+  memset(&addr, 0, sizeof(addr));
+  addr.sun_family = AF_UNIX;
+  if (socket_path.size() >= sizeof(addr.sun_path)) {
+    throw invalid_argument("Socket path is too long: " + socket_path);
+  }
+  strncpy(addr.sun_path, socket_path.c_str(), sizeof(addr.sun_path) - 1);
+  return addr;
+}
+
+/**
+ * @brief Connects to a planning daemon.
+ *
+ * @param socket_path Path the daemon is serving on.
+ * @return Connected file descriptor, or -1 on error.
+ */
+int connect_service(const string &socket_path) {
+  sockaddr_un addr = socket_address(socket_path);
+  int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+  if (fd < 0) { return -1; }
+  if (connect(fd, (sockaddr *) &addr, sizeof(addr)) < 0) {
+    close(fd);
+    return -1;
+  }
+  return fd;
+}
+
+/****************************************************************************/
+
+                              /* Connection */
+
+/****************************************************************************/
+
+/**
+ * @brief Constructor for an accepted connection.
+ *
+ * @param fd Connected socket, owned by the Connection from now on.
+ * @return Connection.
+ */
+Connection::Connection(int fd) {
+  this->fd = fd;
+}
+
+/**
+ * @brief Destructor. Closes the socket.
+ */
+Connection::~Connection() {
+  close(this->fd);
+}
+
+/**
+ * @brief Writes a reply in one piece, so replies from different workers do
+ * not interleave.
+ *
+ * @param header Reply header, num_points must match the path.
+ * @param path Points of the path.
+ * @return True if the reply was written and false if the client is gone.
+ */
+bool Connection::send_reply(const Plan_Reply_Header &header, const vector<Point*> &path) {
+  vector<char> buf(sizeof(header) + 2 * sizeof(double) * path.size());
+  memcpy(buf.data(), &header, sizeof(header));
+  double *coords = (double *) (buf.data() + sizeof(header));
+  for (size_t i = 0; i < path.size(); i++) {
+    coords[2 * i] = path[i]->x;
+    coords[2 * i + 1] = path[i]->y;
+  }
+  lock_guard<mutex> guard(this->write_lock);
+  return write_full(this->fd, buf.data(), buf.size());
+}
+
+/****************************************************************************/
+
+                              /* Plan Service */
+
+/****************************************************************************/
+
+/**
+ * @brief Sets or clears O_NONBLOCK on a file descriptor.
+ *
+ * @param fd File descriptor.
+ * @param nonblocking True to make calls on fd return instead of waiting.
+ * @return Void.
+ */
+void set_nonblocking(int fd, bool nonblocking) {
+  int flags = fcntl(fd, F_GETFL);
+  fcntl(fd, F_SETFL, nonblocking ? (flags | O_NONBLOCK) : (flags & ~O_NONBLOCK));
+}
+
+/**
+ * @brief Constructor for a service. Copies the maps for every worker and
+ * starts the workers.
+ *
+ * @param maps Maps requests can refer to by index, already decomposed.
+ * @param num_workers Number of requests planned at the same time.
+ * @return Service ready to serve.
+ */
+PlanService::PlanService(const vector<Map> &maps, int num_workers) {
+  assert(num_workers > 0);
+  this->stopping = false;
+  if (pipe(this->wake_fds) < 0) {
+    throw runtime_error("PlanService: Unable to create pipe");
+  }
+  /* A burst of signals must not block request_stop on a full pipe */
+  set_nonblocking(this->wake_fds[1], true);
+  this->worker_maps = vector<vector<Map>>(num_workers, maps);
+  random_device entropy;
+  for (int w = 0; w < num_workers; w++) {
+    this->worker_seeds.push_back(mt19937(entropy()));
+  }
+  for (int w = 0; w < num_workers; w++) {
+    this->workers.push_back(thread(&PlanService::work, this, w));
+  }
+}
+
+/**
+ * @brief Destructor. Stops the workers once the queue is empty.
+ */
+PlanService::~PlanService() {
+  this->join_readers(true);
+  this->stop();
+  close(this->wake_fds[0]);
+  close(this->wake_fds[1]);
+}
+
+/**
+ * @brief Makes serve return once the queued requests are answered. Only
+ * writes to a pipe, so it is safe to call from a signal handler.
+ *
+ * @return Void.
+ */
+void PlanService::request_stop() {
+  char wake = 0;
+  ssize_t n = write(this->wake_fds[1], &wake, 1);
+  (void) n; /* A full pipe is already waking serve */
+}
+
+/**
+ * @brief Lets the workers finish the queued requests and waits for them.
+ *
+ * @return Void.
+ */
+void PlanService::stop() {
+  {
+    lock_guard<mutex> guard(this->jobs_lock);
+    this->stopping = true;
+  }
+  this->jobs_ready.notify_all();
+  for (thread &t : this->workers) {
+    if (t.joinable()) { t.join(); }
+  }
+}
+
+/**
+ * @brief Joins the reader threads whose client hung up, or every reader
+ * after shutting down the reading side of its connection. Replies can still
+ * be written to the connections.
+ *
+ * @param all True to stop and join every reader.
+ * @return Void.
+ */
+void PlanService::join_readers(bool all) {
+  list<Reader> finished;
+  {
+    lock_guard<mutex> guard(this->readers_lock);
+    auto it = this->readers.begin();
+    while (it != this->readers.end()) {
+      auto next = std::next(it);
+      if (all) { shutdown(it->conn->fd, SHUT_RD); }
+      if (all || it->done) { finished.splice(finished.end(), this->readers, it); }
+      it = next;
+    }
+  }
+  /* Joined without the lock, which readers take to say they are done */
+  for (Reader &r : finished) {
+    r.reader.join();
+  }
+}
+
+/**
+ * @brief Accepts connections on a Unix domain socket until request_stop is
+ * called, reading the requests of each connection on its own thread.
+ * Replaces a stale socket file left by an earlier daemon. On stopping, it
+ * closes and removes the socket, stops reading requests, answers those
+ * already queued and joins every thread.
+ *
+ * @param socket_path Path to serve on.
+ * @return Void.
+ */
+void PlanService::serve(const string &socket_path) {
+  sockaddr_un addr = socket_address(socket_path);
+  int listen_fd = socket(AF_UNIX, SOCK_STREAM, 0);
+  if (listen_fd < 0) {
+    throw runtime_error("PlanService: Unable to create socket");
+  }
+  unlink(socket_path.c_str());
+  if (bind(listen_fd, (sockaddr *) &addr, sizeof(addr)) < 0 ||
+      listen(listen_fd, SOMAXCONN) < 0) {
+    close(listen_fd);
+    throw runtime_error("PlanService: Unable to listen on " + socket_path);
+  }
+  /* A connection dropped between poll and accept must not block accept */
+  set_nonblocking(listen_fd, true);
+
+  pollfd fds[2] = {{listen_fd, POLLIN, 0}, {this->wake_fds[0], POLLIN, 0}};
+  while (true) {
+    if (poll(fds, 2, -1) < 0) {
+      if (errno == EINTR) { continue; }
+      close(listen_fd);
+      throw runtime_error(string("PlanService: poll failed: ") + strerror(errno));
+    }
+    if (fds[1].revents != 0) { break; }
+
+    int fd = accept(listen_fd, NULL, NULL);
+    if (fd < 0) {
+      if (errno == EINTR || errno == ECONNABORTED || errno == EAGAIN ||
+          errno == EWOULDBLOCK) {
+        continue;
+      }
+      close(listen_fd);
+      throw runtime_error(string("PlanService: accept failed: ") + strerror(errno));
+    }
+    set_nonblocking(fd, false); /* Inherited from listen_fd on some systems */
+
+    this->join_readers(false);
+    lock_guard<mutex> guard(this->readers_lock);
+    this->readers.push_back({make_shared<Connection>(fd), thread(), false});
+    Reader *reader = &this->readers.back();
+    reader->reader = thread(&PlanService::read_requests, this, reader);
+  }
+
+  close(listen_fd);
+  unlink(socket_path.c_str());
+  this->join_readers(true);
+  this->stop();
+}
+
+/**
+ * @brief Queues every request on a connection until the client hangs up,
+ * sends something that is not a request or the service stops.
+ *
+ * @param reader The reader this thread runs, marked done on return.
+ * @return Void.
+ */
+void PlanService::read_requests(Reader *reader) {
+  shared_ptr<Connection> conn = reader->conn;
+  Plan_Request request;
+  while (read_full(conn->fd, &request, sizeof(request))) {
+    if (request.magic != PLAN_MAGIC) {
+      cerr << "PlanService: Dropping client that sent a bad request" << endl;
+      break;
+    }
+
+    Plan_Job job;
+    job.conn = conn;
+    job.request = request;
+    job.arrival = chrono::steady_clock::now();
+    job.deadline = job.arrival + chrono::microseconds(request.budget_us);
+
+    bool queued = false;
+    {
+      lock_guard<mutex> guard(this->jobs_lock);
+      if (this->jobs.size() < SERVICE_MAX_QUEUED) {
+        this->jobs.push(job);
+        queued = true;
+      }
+    }
+    if (queued) {
+      this->jobs_ready.notify_one();
+    } else {
+      Plan_Reply_Header reply = {PLAN_MAGIC, request.id, PLAN_EXPIRED, 0, 0, 0, 0,
+                                 request.seed};
+      conn->send_reply(reply, vector<Point*>());
+    }
+  }
+
+  lock_guard<mutex> guard(this->readers_lock);
+  reader->done = true;
+}
+
+/**
+ * @brief Worker loop. Plans the queued request with the earliest deadline
+ * until the service stops and the queue is empty.
+ *
+ * @param worker Index of this worker.
+ * @return Void.
+ */
+void PlanService::work(int worker) {
+  while (true) {
+    Plan_Job job;
+    {
+      unique_lock<mutex> guard(this->jobs_lock);
+      this->jobs_ready.wait(guard, [this] { return this->stopping || !this->jobs.empty(); });
+      if (this->jobs.empty()) { return; }
+      job = this->jobs.top();
+      this->jobs.pop();
+    }
+    this->plan(worker, job);
+  }
+}
+
+/**
+ * @brief Plans one request on a worker's copy of its map and sends the
+ * reply. Time spent queued counts against the request's budget. The
+ * worker's generator is seeded with the request's seed, or with the
+ * worker's next seed if it is 0. Seeds are drawn apart from the generator
+ * the plans use, which is in the same state after every plan of a seed.
+ *
+ * @param worker Index of the worker.
+ * @param job Request to plan.
+ * @return Void.
+ */
+void PlanService::plan(int worker, const Plan_Job &job) {
+  const Plan_Request &request = job.request;
+  vector<Map> &maps = this->worker_maps[worker];
+  auto begin = chrono::steady_clock::now();
+  chrono::duration<double, milli> queued = begin - job.arrival;
+
+  uint32_t seed = request.seed;
+  while (seed == 0) { seed = this->worker_seeds[worker](); }
+  seed_random(seed);
+
+  Plan_Reply_Header reply = {PLAN_MAGIC, request.id, PLAN_INVALID, 0, 0,
+                             (float) queued.count(), 0, seed};
+  Point start(request.start_x, request.start_y);
+  Point goal(request.goal_x, request.goal_y);
+
+  if (begin >= job.deadline) {
+    reply.status = PLAN_EXPIRED;
+    job.conn->send_reply(reply, vector<Point*>());
+    return;
+  }
+  if (request.map >= maps.size() ||
+      (request.algo != PLAN_RRT_CONNECT && request.algo != PLAN_RRT_STAR &&
+       request.algo != PLAN_RRT_STAR_CONNECT) ||
+      !maps[request.map].is_freespace(start) || !maps[request.map].is_freespace(goal)) {
+    job.conn->send_reply(reply, vector<Point*>());
+    return;
+  }
+
+  Map &map = maps[request.map];
+  PlanResult result =
+      (request.algo == PLAN_RRT_CONNECT) ? Planner::RRT_connect(&start, &goal, map, job.deadline)
+    : (request.algo == PLAN_RRT_STAR) ? Planner::RRT_star(&start, &goal, map, job.deadline)
+    : Planner::RRT_star_connect(&start, &goal, map, job.deadline);
+  chrono::duration<double, milli> planned = chrono::steady_clock::now() - begin;
+
+  reply.status = result.converged ? PLAN_OK : PLAN_PARTIAL;
+  reply.num_points = result.path.size();
+  reply.iterations = result.iterations;
+  reply.plan_ms = planned.count();
+  job.conn->send_reply(reply, result.path);
+}
@@ -0,0 +1,165 @@
+/**
+ *  @file Service.h
+ *  @brief Defines the binary protocol of the planning daemon and a service
+ *  that answers planning requests on a Unix domain socket with a pool of
+ *  worker threads.
+ *
+ *  A client writes Plan_Request structs to the socket, as many as it likes
+ *  without waiting. For each request the service writes back a
+ *  Plan_Reply_Header followed by num_points (x, y) pairs of doubles. Replies
+ *  are sent as soon as their plan finishes, so they can arrive out of order
+ *  and are matched to requests by id. All fields are in host byte order,
+ *  since both ends are on the same machine.
+ *
+ *  Each plan draws its samples from a generator seeded with the request's
+ *  seed, or with one the worker picks if it is 0, and the reply carries the
+ *  seed used. A plan that ends before its deadline is repeated exactly by
+ *  sending the same seed again, whichever worker plans it.
+ *
+ *  On SIGTERM the daemon stops accepting connections and reading requests,
+ *  answers every request already queued and then exits.
+ *
+ *  @author Shashank Ojha (shashano)
+ *  @author Serris Lew (snlew)
+ *  @author David Bick (dbick)
+ *  @bug No known bugs.
+ */
+
+#ifndef __SERVICE_H
+#define __SERVICE_H
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "utils/Map.h"
+#include "utils/Point.h"
+
+#define PLAN_MAGIC 0x50525252 /* "RRRP" */
+
+/* Planners a request can ask for */
+#define PLAN_RRT_CONNECT 0
+#define PLAN_RRT_STAR 1
+#define PLAN_RRT_STAR_CONNECT 2
+
+/* Status of a reply */
+#define PLAN_OK 0       /* Path reaches the goal */
+#define PLAN_PARTIAL 1  /* Path only leads to the closest approach to goal */
+#define PLAN_INVALID 2  /* Unknown map or planner, or start/goal in collision */
+#define PLAN_EXPIRED 3  /* Deadline passed while the request was queued */
+
+/* Requests are refused once this many are waiting for a worker */
+#define SERVICE_MAX_QUEUED 4096
+
+using namespace std;
+
+struct Plan_Request {
+  uint32_t magic;
+  uint32_t id;        /* Echoed in the reply */
+  uint16_t map;       /* Index of the map in the order the daemon loaded them */
+  uint8_t algo;
+  uint8_t reserved;
+  uint32_t budget_us; /* Time from arrival until the reply is due */
+  uint32_t seed;      /* Seeds the plan's samples, 0 lets the worker pick */
+  uint32_t reserved2;
+  double start_x, start_y;
+  double goal_x, goal_y;
+};
+
+struct Plan_Reply_Header {
+  uint32_t magic;
+  uint32_t id;
+  int32_t status;
+  uint32_t num_points;
+  uint32_t iterations;
+  float queue_ms;     /* Time waiting for a worker */
+  float plan_ms;      /* Time spent planning */
+  uint32_t seed;      /* Seed the plan used, to repeat it with */
+};
+
+/* One client connection. Workers share it to write replies, so it is closed
+ * once the reader and every pending reply are done with it. */
+class Connection {
+  public:
+    /* Data */
+    int fd;
+    mutex write_lock;
+
+    /* Constructors */
+    Connection(int fd);
+    ~Connection();
+
+    /* Function Prototypes */
+    bool send_reply(const Plan_Reply_Header &header, const vector<Point*> &path);
+};
+
+/* Request waiting for a worker */
+struct Plan_Job {
+  shared_ptr<Connection> conn;
+  Plan_Request request;
+  chrono::steady_clock::time_point arrival;
+  chrono::steady_clock::time_point deadline;
+};
+
+/* Thread reading the requests of one connection */
+struct Reader {
+  shared_ptr<Connection> conn;
+  thread reader;
+  bool done; /* Client hung up, the thread can be joined */
+};
+
+/* Orders the queue so the job due soonest is planned first */
+struct Later_Deadline {
+  bool operator()(const Plan_Job &a, const Plan_Job &b) const {
+    return a.deadline > b.deadline;
+  }
+};
+
+/* Planning daemon. Maps are parsed and decomposed once at startup and every
+ * worker gets its own copy, since sampling updates statistics in the Map.
+ * Plans draw from the generator of their worker's thread, see
+ * utils/Random.h, which is reseeded for every request. */
+class PlanService {
+  public:
+    /* Data */
+    vector<vector<Map>> worker_maps; /* worker_maps[w][m] is map m of worker w */
+    vector<mt19937> worker_seeds;    /* Seeds for requests that leave it to worker w */
+    vector<thread> workers;
+    priority_queue<Plan_Job, vector<Plan_Job>, Later_Deadline> jobs;
+    mutex jobs_lock;
+    condition_variable jobs_ready;
+    bool stopping;
+    list<Reader> readers;
+    mutex readers_lock;
+    int wake_fds[2]; /* Pipe request_stop writes to, to wake serve */
+
+    /* Constructors */
+    PlanService(const vector<Map> &maps, int num_workers);
+    ~PlanService();
+
+    /* Function Prototypes */
+    void serve(const string &socket_path);
+    void request_stop();
+    void stop();
+
+  private:
+    void read_requests(Reader *reader);
+    void join_readers(bool all);
+    void work(int worker);
+    void plan(int worker, const Plan_Job &job);
+};
+
+/* Function Prototypes */
+bool read_full(int fd, void *buf, size_t len);
+bool write_full(int fd, const void *buf, size_t len);
+int connect_service(const string &socket_path);
+
+#endif /* __SERVICE_H */
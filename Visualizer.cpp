@@ -9,7 +9,7 @@
 #include <iostream>
 #include <stdlib.h>
 #include <math.h>
-#include <GLUT/glut.h>
+#include <unordered_map>
 #include <vector>
 
 #include "utils/Point.h"
@@ -19,6 +19,50 @@
 
 using namespace std;
 
+/* Edges are keyed by the ids of their ends, smaller id first */
+struct Edge_Key_Hash {
+    size_t operator()(const pair<uint64_t, uint64_t> &key) const {
+        return hash<uint64_t>()(key.first * 0x9e3779b97f4a7c15ULL ^ key.second);
+    }
+};
+
+/* State of the live view, shared with GLUT's static callbacks */
+struct Live_View {
+    Tree_Stream *stream;
+    Color node_color, edge_color, path_color;
+    GLuint background; /* Display list replayed on every full redraw, 0 if none */
+    unordered_map<pair<uint64_t, uint64_t>, pair<Point, Point>, Edge_Key_Hash> edges;
+    vector<pair<Point, Point>> path;
+    vector<Tree_Event> batch;
+};
+
+static Live_View live = {NULL, {0, 0, 0}, {0, 0, 0}, {0, 0, 0}, 0, {}, {}, {}};
+
+static void live_vertex(const Point &p) {
+    glVertex2f(p.x * SCALE, p.y * SCALE);
+}
+
+static void live_segments(const vector<pair<Point, Point>> &segments, Color &node_color,
+                          Color &edge_color) {
+    glLineWidth(5.0);
+    glBegin(GL_LINES);
+    glColor3f(edge_color.r, edge_color.g, edge_color.b);
+    for (auto &segment : segments) {
+        live_vertex(segment.first);
+        live_vertex(segment.second);
+    }
+    glEnd();
+
+    glPointSize(10);
+    glBegin(GL_POINTS);
+    glColor3f(node_color.r, node_color.g, node_color.b);
+    for (auto &segment : segments) {
+        live_vertex(segment.first);
+        live_vertex(segment.second);
+    }
+    glEnd();
+}
+
 Visualizer::Visualizer() {}
 
 void Visualizer::plot_circle(Point &p, double radius, Color &node_color) {
@@ -82,10 +126,10 @@ void Visualizer::plot_trajectory(vector<Point*> &trajectory, Color &node_color,
     }
 }
 
-void Visualizer::plot_graph(Graph<Point> &graph, Color &node_color, Color &edge_color) {
-    for (auto pair : graph.adj_list) {
+void Visualizer::plot_graph(const Graph<Point> &graph, Color &node_color, Color &edge_color) {
+    for (auto &pair : graph.adj_list) {
         Point *p1 = pair.first;
-        unordered_set<Point*> set = pair.second;
+        const Graph<Point>::Neighbors &set = pair.second;
         for (auto *p2 : set) {
             double x1 = rescale(p1->x);
             double y1 = rescale(p1->y);
@@ -96,6 +140,30 @@ void Visualizer::plot_graph(Graph<Point> &graph, Color &node_color, Color &edge_
     }
 }
 
+void Visualizer::plot_graph(const FrozenGraph<Point> &graph, Color &node_color, Color &edge_color) {
+    glLineWidth(5.0);
+    glBegin(GL_LINES);
+    glColor3f(edge_color.r, edge_color.g, edge_color.b);
+    for (int i = 0; i < graph.num_vertices(); i++) {
+        const Point &p1 = graph.point(i);
+        for (const Dense_Edge &edge : graph.neighbors(i)) {
+            if (edge.to < i) { continue; } /* Each edge is stored both ways */
+            const Point &p2 = graph.point(edge.to);
+            glVertex2f(rescale(p1.x), rescale(p1.y));
+            glVertex2f(rescale(p2.x), rescale(p2.y));
+        }
+    }
+    glEnd();
+
+    glPointSize(10);
+    glBegin(GL_POINTS);
+    glColor3f(node_color.r, node_color.g, node_color.b);
+    for (const Point &p : graph.points) {
+        glVertex2f(rescale(p.x), rescale(p.y));
+    }
+    glEnd();
+}
+
 void Visualizer::plot_obstacle(vector<Point> &obstacles, Color &edge_color) {
     glBegin(GL_POLYGON);
     glColor3f(edge_color.r, edge_color.g, edge_color.b);
@@ -134,3 +202,77 @@ void Visualizer::run() {
     glFlush();
     glutMainLoop();
 }
+
+// Everything plotted from here until run_live is redrawn on every full redraw
+void Visualizer::record_background() {
+    live.background = glGenLists(1);
+    glNewList(live.background, GL_COMPILE_AND_EXECUTE);
+}
+
+// Shows the tree grow as the planner thread pushes changes into stream
+void Visualizer::run_live(Tree_Stream &stream, Color &node_color, Color &edge_color,
+                          Color &path_color) {
+    if (live.background != 0) { glEndList(); }
+    live.stream = &stream;
+    live.node_color = node_color;
+    live.edge_color = edge_color;
+    live.path_color = path_color;
+    live.batch.resize(TREE_DRAIN_BATCH);
+
+    glutDisplayFunc(live_display);
+    glutTimerFunc(LIVE_FRAME_MS, live_frame, 0);
+    glFlush();
+    glutMainLoop();
+}
+
+void Visualizer::live_display() {
+    glClear(GL_COLOR_BUFFER_BIT);
+    if (live.background != 0) { glCallList(live.background); }
+
+    vector<pair<Point, Point>> edges;
+    edges.reserve(live.edges.size());
+    for (auto &edge : live.edges) {
+        edges.push_back(edge.second);
+    }
+    live_segments(edges, live.node_color, live.edge_color);
+    live_segments(live.path, live.path_color, live.path_color);
+    glFlush();
+}
+
+// Drains the stream once per frame. New edges are drawn on top of the
+// frame, anything else redraws it from scratch.
+void Visualizer::live_frame(int value) {
+    vector<pair<Point, Point>> added;
+    bool redraw = false;
+    size_t n;
+    size_t budget = live.stream->events.capacity();
+    while (budget > 0 && (n = live.stream->drain(live.batch.data(), min(budget, live.batch.size()))) > 0) {
+        budget -= n;
+        for (size_t i = 0; i < n; i++) {
+            const Tree_Event &event = live.batch[i];
+            pair<uint64_t, uint64_t> key = {min(event.a_id, event.b_id), max(event.a_id, event.b_id)};
+            if (event.kind == TREE_WATCH) {
+                live.edges.clear();
+                live.path.clear();
+                added.clear();
+                redraw = true;
+            } else if (event.kind == TREE_ADD_EDGE) {
+                live.edges[key] = {event.a, event.b};
+                added.push_back({event.a, event.b});
+            } else if (event.kind == TREE_REMOVE_EDGE) {
+                redraw |= (live.edges.erase(key) > 0);
+            } else if (event.kind == TREE_PATH) {
+                live.path.push_back({event.a, event.b});
+                redraw = true;
+            }
+        }
+    }
+
+    if (redraw) {
+        glutPostRedisplay();
+    } else if (!added.empty()) {
+        live_segments(added, live.node_color, live.edge_color);
+        glFlush();
+    }
+    glutTimerFunc(LIVE_FRAME_MS, live_frame, value);
+}
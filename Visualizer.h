@@ -16,17 +16,25 @@
 #include <iostream>
 #include <stdlib.h>
 #include <math.h>
+#ifdef __APPLE__
 #include <GLUT/glut.h>
+#else
+#include <GL/glut.h>
+#endif
 #include <vector>
 
 #include "utils/Point.h"
 #include "utils/Graph.h"
+#include "utils/TreeStream.h"
 
 /* Constants about our Display Screen */
 #define SCREEN_WIDTH 900
 #define SCREEN_HEIGHT 900
 #define SCALE 0.05
 
+/* Milliseconds between frames of the live view */
+#define LIVE_FRAME_MS 16
+
 /* Struct to keep track of Colors */
 struct Color {
     GLbyte r, g, b;
@@ -43,14 +51,20 @@ class Visualizer {
     void plot_point(Point &p, Color &node_color);
     void plot_segment(Point &p1, Point &p2, Color &node_color, Color &edge_color);
     void plot_trajectory(vector<Point*> &trajectory, Color &node_color, Color &edge_color);
-    void plot_graph(Graph<Point> &graph, Color &node_color, Color &edge_color);
+    void plot_graph(const Graph<Point> &graph, Color &node_color, Color &edge_color);
+    void plot_graph(const FrozenGraph<Point> &graph, Color &node_color, Color &edge_color);
     void plot_obstacle(vector<Point> &obstacles, Color &edge_color);
     
     static void display();
+    static void live_display();
+    static void live_frame(int value);
 
     double rescale(double p);
     void init(int argc, char *argv[]);
     void run();
+    void record_background();
+    void run_live(Tree_Stream &stream, Color &node_color, Color &edge_color,
+                  Color &path_color);
 };
 
 #endif /* __VISUALIZER_H */
@@ -0,0 +1,213 @@
+/**
+ *  @file batch.cpp
+ *  @brief Headless front end that plans every start/goal query in a file on
+ *  one map and streams a line per query to stdout as soon as it is planned.
+ *  Links against the planner library only, so it builds without OpenGL.
+ *
+ *  @author Shashank Ojha (shashano)
+ *  @author Serris Lew (snlew)
+ *  @author David Bick (dbick)
+ *  @bug No known bugs.
+ */
+
+#include <chrono>
+#include <cstdlib>
+#include <ctime>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "utils/Map.h"
+#include "utils/Memory.h"
+#include "utils/PlanFile.h"
+#include "utils/Point.h"
+#include "utils/Random.h"
+#include "utils/Trace.h"
+#include "utils/TreeStream.h"
+
+#include "Planner.h"
+
+#define MS 1000
+#define RRT_CONNECT 0
+#define RRT_STAR 1
+#define RRT_STAR_CONNECT 2
+#define DEFAULT_BUDGET_MS 1000
+#define STREAM_CAPACITY (1 << 16)
+
+using namespace std;
+
+void usage() {
+  cerr << "Usage: ./plan-batch MAP QUERIES [ALGO] [BUDGET_MS] [LOG] [STREAM] [TRACE] "
+       << "[SAMPLER]" << endl;
+  cerr << "\t QUERIES has one query per line: xs ys xt yt" << endl;
+  cerr << "\t Blank lines and lines starting with # are skipped." << endl;
+  cerr << "\t Algo is 0 for RRT-Connect, 1 for anytime RRT-Star and 2 for "
+       << "anytime bidirectional RRT-Star." << endl;
+  cerr << "\t Each query returns within about BUDGET_MS milliseconds "
+       << "(default " << DEFAULT_BUDGET_MS << ")." << endl;
+  cerr << "\t Every plan and its tree are appended to LOG in the binary "
+       << "format of utils/PlanFile.h, see plan-dump." << endl;
+  cerr << "\t Every change to the trees is recorded to STREAM, see "
+       << "./plan MAP replay STREAM. Use - for LOG or STREAM to skip them." << endl;
+  cerr << "\t A timeline of every plan is written to TRACE as Chrome trace "
+       << "event JSON. Needs a build with make TRACE=1. Use - to skip it." << endl;
+  cerr << "\t SAMPLER is BRIDGE,GAUSSIAN[,SIGMA]: the fractions of samples drawn "
+       << "by the bridge test and Gaussian samplers, the rest uniform, and the "
+       << "spread of both (default twice the robot radius)." << endl;
+  exit(1);
+}
+
+/**
+ * @brief Computes the length of a path.
+ *
+ * @param path Points along the path.
+ * @return Sum of the lengths of its segments.
+ */
+double path_cost(const vector<Point*> &path) {
+  double cost = 0;
+  for (size_t i = 1; i < path.size(); i++) {
+    cost += path[i - 1]->dist(*path[i]);
+  }
+  return cost;
+}
+
+/**
+ * @brief Sets the mix of samplers of a map from a SAMPLER argument.
+ *
+ * @param spec BRIDGE,GAUSSIAN[,SIGMA] as given on the command line.
+ * @param map A map object.
+ * @return False if spec is malformed or its fractions add up to more than 1.
+ */
+bool parse_sampler(const string &spec, Map &map) {
+  istringstream fields(spec);
+  double bridge, gaussian;
+  double sigma = map.sample_sigma;
+  char comma;
+  if (!(fields >> bridge >> comma >> gaussian) || comma != ',') { return false; }
+  if (fields >> comma && (comma != ',' || !(fields >> sigma))) { return false; }
+  if (!fields.eof() || bridge < 0 || gaussian < 0 || bridge + gaussian > 1 || sigma <= 0) {
+    return false;
+  }
+  map.bridge_ratio = bridge;
+  map.gaussian_ratio = gaussian;
+  map.sample_sigma = sigma;
+  return true;
+}
+
+/**
+ * @brief Writes one result line: the query number, a status of ok, partial
+ * (the path only leads to the closest approach to goal) or invalid (start or
+ * goal is not in free space), the plan time, iterations, path cost, peak
+ * memory in KiB, allocations, number of waypoints and then the waypoints
+ * themselves.
+ *
+ * @return Void.
+ */
+void print_result(int id, const string &status, double time_ms, int iterations,
+                  const Mem_Usage &memory, const vector<Point*> &path) {
+  cout << id << " " << status << " " << time_ms << " " << iterations << " "
+       << path_cost(path) << " " << memory.peak_bytes / 1024.0 << " "
+       << memory.allocations << " " << path.size();
+  for (Point *p : path) {
+    cout << " " << p->x << " " << p->y;
+  }
+  cout << endl; /* Flushes, so consumers see every result as it is planned */
+}
+
+int main(int argc, char *argv[]) {
+  if (argc < 3 || argc > 9) { usage(); }
+  string map_file = string(argv[1]);
+  string query_file = string(argv[2]);
+  int algo = (argc > 3) ? atoi(argv[3]) : RRT_CONNECT;
+  double budget_ms = (argc > 4) ? atof(argv[4]) : DEFAULT_BUDGET_MS;
+  PlanWriter *plan_log = (argc > 5 && string(argv[5]) != "-")
+      ? new PlanWriter(string(argv[5])) : NULL;
+
+  /* Recorded on a background thread, so planning only pays for the copies */
+  Tree_Stream stream(STREAM_CAPACITY);
+  Tree_Recorder *recorder = (argc > 6 && string(argv[6]) != "-")
+      ? new Tree_Recorder(stream, string(argv[6])) : NULL;
+  if (recorder != NULL) { Planner::listener = &stream; }
+  if ((algo != RRT_CONNECT && algo != RRT_STAR && algo != RRT_STAR_CONNECT) ||
+      budget_ms <= 0) {
+    usage();
+  }
+  string trace_file = (argc > 7 && string(argv[7]) != "-") ? string(argv[7]) : "";
+  if (!trace_file.empty()) {
+    if (!Trace::compiled_in()) {
+      cerr << "Tracing is not compiled in, rebuild with make clean && make TRACE=1" << endl;
+      return 1;
+    }
+    Trace::start();
+  }
+
+  seed_random((unsigned) time(0));
+  double robot_radius = 1;
+  Map map = Map(robot_radius, map_file);
+  if (argc > 8 && !parse_sampler(string(argv[8]), map)) { usage(); }
+
+  ifstream queries(query_file);
+  if (!queries) {
+    cerr << "Unable to open " << query_file << endl;
+    return 1;
+  }
+
+  cout << fixed << setprecision(3);
+  cout << "# id status time_ms iterations cost peak_kb allocations num_points x1 y1 ... xn yn" << endl;
+
+  string line;
+  int line_num = 0;
+  int id = 0;
+  while (getline(queries, line)) {
+    line_num += 1;
+    size_t first = line.find_first_not_of(" \t\r");
+    if (first == string::npos || line[first] == '#') { continue; }
+
+    istringstream fields(line);
+    double xs, ys, xt, yt;
+    if (!(fields >> xs >> ys >> xt >> yt)) {
+      cerr << query_file << ":" << line_num << ": expected xs ys xt yt" << endl;
+      continue;
+    }
+
+    Point start(xs, ys);
+    Point goal(xt, yt);
+    if (!map.is_freespace(start) || !map.is_freespace(goal)) {
+      print_result(id++, "invalid", 0, 0, {0, 0, 0}, vector<Point*>());
+      continue;
+    }
+
+    TRACE_SCOPE("plan", id);
+    auto start_time = chrono::steady_clock::now();
+    auto deadline = start_time + chrono::microseconds((long) (budget_ms * MS));
+    PlanResult plan = (algo == RRT_CONNECT) ? Planner::RRT_connect(&start, &goal, map, deadline)
+                    : (algo == RRT_STAR) ? Planner::RRT_star(&start, &goal, map, deadline)
+                    : Planner::RRT_star_connect(&start, &goal, map, deadline);
+    chrono::duration<double, milli> elapsed = chrono::steady_clock::now() - start_time;
+
+    print_result(id++, plan.converged ? "ok" : "partial", elapsed.count(),
+                 plan.iterations, plan.memory, plan.path);
+    if (recorder != NULL) { stream.add_path(plan.path); }
+    if (plan_log != NULL) {
+      plan_log->write(plan.path, plan.has_tree() ? &plan.tree() : NULL, &start,
+                 plan.converged, plan.iterations);
+    }
+  }
+  delete plan_log;
+  if (!trace_file.empty()) {
+    Trace::stop();
+    Trace::write(trace_file);
+    if (Trace::dropped() > 0) {
+      cerr << Trace::dropped() << " trace events were dropped" << endl;
+    }
+  }
+  Planner::listener = NULL;
+  delete recorder;
+  if (stream.dropped > 0) {
+    cerr << stream.dropped << " tree changes were dropped from the stream" << endl;
+  }
+  return 0;
+}
@@ -0,0 +1,690 @@
+/**
+ *  @file bench.cpp
+ *  @brief Performance regression suite. Runs fixed seed scenarios on the
+ *  bundled maps and on a generated large map through both planners, times
+ *  KD-tree queries, collision checks and free space sampling, compares the samplers on a map of
+ *  narrow doors, and compares every figure with a baseline file. Exits with
+ *  status 1 if any figure is worse than its baseline by more than the
+ *  tolerance given next to it.
+ *
+ *  Times are reported in millionths of a calibration loop that uses none of
+ *  the planner's code, timed just before each scenario, so that a baseline
+ *  carries over between machines of different speed and a machine slowing
+ *  down mid run does not count as a regression.
+ *
+ *  @author Shashank Ojha (shashano)
+ *  @author Serris Lew (snlew)
+ *  @author David Bick (dbick)
+ *  @bug No known bugs.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <random>
+#include <set>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <unistd.h>
+
+#include "utils/KDTree.h"
+#include "utils/Map.h"
+#include "utils/MapGen.h"
+#include "utils/Point.h"
+
+#include "Planner.h"
+
+#define BENCH_SEED 15418
+#define REPEATS 5 /* Times are the fastest of this many runs */
+#define RETRIES 2 /* Runs again of scenarios that look slower */
+
+/* Tolerances given to figures new to the baseline. A percentage is relative
+ * to the baseline, a plain number is added to it, and Ksd/N allows K binomial
+ * standard deviations of a fraction of N trials. */
+#define TIME_TOLERANCE "30%"
+#define COUNT_TOLERANCE "10%"
+#define COST_TOLERANCE "5%"
+#define MEMORY_TOLERANCE "10%"
+#define OVERSHOOT_TOLERANCE "1"
+
+/* Generated map: clutter of convex obstacles, one to a cell of a grid,
+ * sized by utils/MapGen.h to a 120 x 120 map */
+#define LARGE_OBSTACLES 240
+#define LARGE_DENSITY 0.07
+
+/* Generated map: a row of walls, each with a door the robot barely fits
+ * through, planned from the first bay to the last with each sampler mix */
+#define NARROW_OBSTACLES 10
+#define NARROW_RUNS 20
+#define NARROW_BUDGET_MS 250
+#define FAILURE_TOLERANCE "2sd/20" /* NARROW_RUNS trials */
+
+#define KD_POINTS 100000
+#define KD_HALF_SIZE 60
+#define KD_QUERIES 20000
+#define KD_RADIUS 2
+#define SEGMENTS 100000
+#define SAMPLES 100000
+#define REJECTION_TOLERANCE "0.01"
+#define SEGMENT_LENGTH 4
+#define DEADLINE_MS 20
+#define DEADLINE_RUNS 10
+
+/* Generated map: a few clusters in open space, where RRT* trees grow large
+ * enough within the budget for relayouts and prunes to take milliseconds */
+#define OPEN_OBSTACLES 200
+#define OPEN_BUDGET_MS 300
+#define OPEN_RUNS 3
+
+/* Calibration loop: sorts square roots of random numbers. It takes this
+ * many units of time, the unit of every .time figure. */
+#define CALIBRATION_SIZE 50000
+#define CALIBRATION_REPEATS 5
+#define CALIBRATION_UNITS 1000000
+
+using namespace std;
+
+/* One measured figure. Lower is better for all of them. */
+struct Metric {
+  string name;
+  double value;
+  string tolerance;
+  int scenario; /* Index of the scenario that measures it */
+};
+
+vector<Metric> metrics;
+int current_scenario = 0;
+double calibration_ms = 1; /* Time of the calibration loop, see calibrate */
+
+void usage() {
+  cerr << "Usage: ./plan-bench BASELINE [update]" << endl;
+  cerr << "\t Runs every scenario and compares it with BASELINE, exiting with "
+       << "status 1 on a regression." << endl;
+  cerr << "\t update rewrites the values in BASELINE with this run, keeping "
+       << "its tolerances." << endl;
+  exit(1);
+}
+
+/**
+ * @brief Adds a figure to the results. A figure measured again keeps the
+ * best of its values.
+ *
+ * @param name Name of the figure in the baseline.
+ * @param value Measured value.
+ * @param tolerance Tolerance used if the baseline has none.
+ * @return Void.
+ */
+void report(const string &name, double value, const string &tolerance) {
+  cerr << "  " << name << " " << value << endl;
+  for (Metric &m : metrics) {
+    if (m.name == name) {
+      m.value = min(m.value, value);
+      return;
+    }
+  }
+  metrics.push_back({name, value, tolerance, current_scenario});
+}
+
+/**
+ * @brief Adds a time to the results in units of the calibration loop.
+ *
+ * @param name Name of the figure in the baseline, without the .time suffix.
+ * @param ms Measured time in milliseconds.
+ * @return Void.
+ */
+void report_time(const string &name, double ms) {
+  report(name + ".time", ms / calibration_ms * CALIBRATION_UNITS, TIME_TOLERANCE);
+}
+
+/**
+ * @brief Milliseconds since a point in time.
+ *
+ * @param start Point in time on the monotonic clock.
+ * @return Elapsed milliseconds.
+ */
+double elapsed_ms(chrono::steady_clock::time_point start) {
+  chrono::duration<double, milli> elapsed = chrono::steady_clock::now() - start;
+  return elapsed.count();
+}
+
+/**
+ * @brief Times a fixed loop of random numbers, square roots and a sort that
+ * does not use any of the planner's code, as the unit of time of the
+ * scenario that runs next.
+ *
+ * @return Fastest time of the loop in milliseconds.
+ */
+double calibrate() {
+  double best_ms = 1e18;
+  double sum = 0;
+  for (int r = 0; r < CALIBRATION_REPEATS; r++) {
+    auto start_time = chrono::steady_clock::now();
+    mt19937 gen(BENCH_SEED);
+    vector<double> values(CALIBRATION_SIZE);
+    for (double &v : values) { v = sqrt((double) gen()); }
+    sort(values.begin(), values.end());
+    sum += values[CALIBRATION_SIZE / 2];
+    best_ms = min(best_ms, elapsed_ms(start_time));
+  }
+  if (sum < 0) { cerr << sum << endl; } /* Keeps the loop alive */
+  return best_ms;
+}
+
+/**
+ * @brief Runs a scenario in units of a calibration loop timed just before.
+ *
+ * @param index Index of the scenario.
+ * @param scenario The scenario.
+ * @return Void.
+ */
+void run_scenario(int index, const function<void()> &scenario) {
+  current_scenario = index;
+  calibration_ms = calibrate();
+  scenario();
+}
+
+/**
+ * @brief Loads a generated map through a temporary file.
+ *
+ * @param generated Generated map.
+ * @param robot_radius Radius of the robot.
+ * @return Map of the generated obstacles.
+ */
+Map load_generated_map(const Generated_Map &generated, double robot_radius) {
+  char path[] = "/tmp/plan-bench-XXXXXX";
+  int fd = mkstemp(path);
+  if (fd < 0) {
+    cerr << "Unable to create a temporary map file" << endl;
+    exit(1);
+  }
+  close(fd);
+  generated.write(path);
+  Map map(robot_radius, string(path));
+  unlink(path);
+  return map;
+}
+
+/**
+ * @brief Exits if a scenario's query is not in free space, since every plan
+ * of it would fail in no time.
+ *
+ * @param name Prefix of the figures.
+ * @param map A map object.
+ * @param start Starting Point.
+ * @param goal Target Point.
+ * @return Void.
+ */
+void check_query(const string &name, Map &map, const Point &start, const Point &goal) {
+  if (!map.is_freespace(start) || !map.is_freespace(goal)) {
+    cerr << name << ": start or goal is not in free space" << endl;
+    exit(1);
+  }
+}
+
+/**
+ * @brief Plans the same query repeatedly with RRT-Connect. Reports the time
+ * per plan and the nodes and collision checks per plan.
+ *
+ * @param name Prefix of the figures.
+ * @param map A map object.
+ * @param start Starting Point.
+ * @param goal Target Point.
+ * @param num_plans Plans per run.
+ * @return Void.
+ */
+void bench_rrt_connect(const string &name, Map &map, Point start, Point goal,
+                       int num_plans) {
+  check_query(name, map, start, goal);
+  double best_ms = 1e18;
+  long nodes = 0;
+  for (int r = 0; r < REPEATS; r++) {
+    seed_random(BENCH_SEED);
+    map.num_path_checks = 0;
+    nodes = 0;
+    auto start_time = chrono::steady_clock::now();
+    for (int i = 0; i < num_plans; i++) {
+      PlanResult plan = Planner::RRT_connect(&start, &goal, map);
+      nodes += plan.tree().num_vertices;
+    }
+    best_ms = min(best_ms, elapsed_ms(start_time));
+  }
+  report_time(name + ".connect", best_ms / num_plans);
+  report(name + ".connect.nodes", (double) nodes / num_plans, COUNT_TOLERANCE);
+  report(name + ".connect.checks", (double) map.num_path_checks / num_plans,
+         COUNT_TOLERANCE);
+}
+
+/**
+ * @brief Grows an Informed RRT* tree for a fixed number of iterations.
+ * Reports the time, tree nodes, collision checks, final cost and peak memory.
+ *
+ * @param name Prefix of the figures.
+ * @param map A map object.
+ * @param start Starting Point.
+ * @param goal Target Point.
+ * @param num_iterations Samples to draw.
+ * @return Void.
+ */
+void bench_rrt_star(const string &name, Map &map, Point start, Point goal,
+                    int num_iterations) {
+  check_query(name, map, start, goal);
+  double best_ms = 1e18;
+  int nodes = 0;
+  double cost = 0;
+  double peak_kb = 0;
+  vector<Cost_Sample> curve;
+  for (int r = 0; r < REPEATS; r++) {
+    seed_random(BENCH_SEED);
+    map.num_path_checks = 0;
+    auto start_time = chrono::steady_clock::now();
+    PlanResult plan = Planner::RRT_star_informed(&start, &goal, map, num_iterations, curve);
+    best_ms = min(best_ms, elapsed_ms(start_time));
+    nodes = plan.tree().num_vertices;
+    cost = curve.empty() ? 0 : curve.back().cost;
+    peak_kb = plan.memory.peak_bytes / 1024.0;
+  }
+  report_time(name + ".star", best_ms);
+  report(name + ".star.nodes", nodes, COUNT_TOLERANCE);
+  report(name + ".star.checks", map.num_path_checks, COUNT_TOLERANCE);
+  report(name + ".star.cost", cost, COST_TOLERANCE);
+  report(name + ".star.peak_kb", peak_kb, MEMORY_TOLERANCE);
+}
+
+/**
+ * @brief Times collision checks of random points and of random segments of
+ * up to SEGMENT_LENGTH long.
+ *
+ * @param name Prefix of the figures.
+ * @param map A map object.
+ * @return Void.
+ */
+void bench_collisions(const string &name, Map &map) {
+  mt19937 gen(BENCH_SEED);
+  uniform_real_distribution<double> x(-map.width, map.width);
+  uniform_real_distribution<double> y(-map.height, map.height);
+  uniform_real_distribution<double> angle(0, 2 * M_PI);
+  uniform_real_distribution<double> length(0, SEGMENT_LENGTH);
+  vector<pair<Point, Point>> segments;
+  for (int i = 0; i < SEGMENTS; i++) {
+    Point a(x(gen), y(gen));
+    double t = angle(gen);
+    double l = length(gen);
+    segments.push_back({a, a + Point(l * cos(t), l * sin(t))});
+  }
+
+  double best_point_ms = 1e18;
+  double best_path_ms = 1e18;
+  long num_free = 0;
+  for (int r = 0; r < REPEATS; r++) {
+    num_free = 0;
+    auto start_time = chrono::steady_clock::now();
+    for (auto &s : segments) { num_free += map.is_freespace(s.first); }
+    best_point_ms = min(best_point_ms, elapsed_ms(start_time));
+
+    start_time = chrono::steady_clock::now();
+    for (auto &s : segments) { num_free += map.is_valid_path(s.first, s.second); }
+    best_path_ms = min(best_path_ms, elapsed_ms(start_time));
+  }
+  if (num_free < 0) { cerr << num_free << endl; } /* Keeps the checks alive */
+  report_time(name + ".point_check", best_point_ms / SEGMENTS);
+  report_time(name + ".path_check", best_path_ms / SEGMENTS);
+}
+
+/**
+ * @brief Draws free samples by rejection from the whole map and from the
+ * decomposition of its free space, and reports the time per sample and the
+ * fraction of draws rejected by each.
+ *
+ * @param name Prefix of the figures.
+ * @param map A map object, left sampling as it did.
+ * @return Void.
+ */
+void bench_sampling(const string &name, Map &map) {
+  if (!map.decomposed) { map.decompose_freespace(); }
+  bool use_decomposition = map.use_decomposition;
+  for (bool decompose : {false, true}) {
+    map.use_decomposition = decompose;
+    string prefix = name + (decompose ? ".sample.decomposition" : ".sample.rejection");
+    double best_ms = 1e18;
+    for (int r = 0; r < REPEATS; r++) {
+      seed_random(BENCH_SEED);
+      map.num_samples = 0;
+      map.num_rejections = 0;
+      auto start_time = chrono::steady_clock::now();
+      for (int i = 0; i < SAMPLES; i++) { map.sample_freespace(); }
+      best_ms = min(best_ms, elapsed_ms(start_time));
+    }
+    report_time(prefix, best_ms / SAMPLES);
+    report(prefix + ".rate", map.rejection_rate(), REJECTION_TOLERANCE);
+  }
+  map.use_decomposition = use_decomposition;
+}
+
+/**
+ * @brief Times inserts, nearest neighbor and radius queries on a KD-tree of
+ * uniformly random points.
+ *
+ * @return Void.
+ */
+void bench_kdtree() {
+  mt19937 gen(BENCH_SEED);
+  uniform_real_distribution<double> coord(-KD_HALF_SIZE, KD_HALF_SIZE);
+  vector<Point*> points;
+  for (int i = 0; i < KD_POINTS; i++) { points.push_back(new Point(coord(gen), coord(gen))); }
+  vector<Point> queries;
+  for (int i = 0; i < KD_QUERIES; i++) { queries.push_back(Point(coord(gen), coord(gen))); }
+
+  double best_insert_ms = 1e18;
+  double best_nearest_ms = 1e18;
+  double best_radius_ms = 1e18;
+  size_t found = 0;
+  for (int r = 0; r < REPEATS; r++) {
+    auto start_time = chrono::steady_clock::now();
+    KDTree tree(points[0]);
+    for (int i = 1; i < KD_POINTS; i++) { tree.insert_node(points[i]); }
+    best_insert_ms = min(best_insert_ms, elapsed_ms(start_time));
+
+    start_time = chrono::steady_clock::now();
+    for (Point &q : queries) { found += (size_t) tree.nearest_neighbor(&q) & 1; }
+    best_nearest_ms = min(best_nearest_ms, elapsed_ms(start_time));
+
+    start_time = chrono::steady_clock::now();
+    for (Point &q : queries) { found += tree.points_in_radius(&q, KD_RADIUS).size(); }
+    best_radius_ms = min(best_radius_ms, elapsed_ms(start_time));
+  }
+  for (Point *p : points) { delete p; }
+  if (found == 0) { cerr << "No points found" << endl; } /* Keeps the queries alive */
+  report_time("kdtree.insert", best_insert_ms / KD_POINTS);
+  report_time("kdtree.nearest", best_nearest_ms / KD_QUERIES);
+  report_time("kdtree.radius", best_radius_ms / KD_QUERIES);
+}
+
+/**
+ * @brief Runs anytime RRT* under a deadline and reports the worst time it
+ * returned past the deadline.
+ *
+ * @param name Prefix of the figures.
+ * @param map A map object.
+ * @param start Starting Point.
+ * @param goal Target Point.
+ * @param budget_ms Time each plan is given.
+ * @param num_runs Number of plans.
+ * @return Void.
+ */
+void bench_deadline(const string &name, Map &map, Point start, Point goal,
+                    int budget_ms, int num_runs) {
+  check_query(name, map, start, goal);
+  seed_random(BENCH_SEED);
+  double worst = 0;
+  for (int i = 0; i < num_runs; i++) {
+    auto deadline = chrono::steady_clock::now() + chrono::milliseconds(budget_ms);
+    PlanResult plan = Planner::RRT_star(&start, &goal, map, deadline);
+    worst = max(worst, plan.overshoot_ms);
+  }
+  report(name + ".overshoot.ms", worst, OVERSHOOT_TOLERANCE);
+}
+
+/**
+ * @brief Plans the same query with RRT-Connect under a deadline, drawing
+ * samples from each mix of uniform, bridge test and Gaussian samplers.
+ * Reports per mix the fraction of plans that found no path in time and the
+ * median time to a path, counting those that found none as the deadline.
+ *
+ * @param name Prefix of the figures.
+ * @param map A map object, left sampling uniformly.
+ * @param start Starting Point.
+ * @param goal Target Point.
+ * @return Void.
+ */
+void bench_samplers(const string &name, Map &map, Point start, Point goal) {
+  check_query(name, map, start, goal);
+  struct Mix { string name; float bridge; float gaussian; };
+  vector<Mix> mixes = {
+    {"uniform", 0, 0}, {"bridge", 0.5, 0}, {"gaussian", 0, 0.5}, {"mixed", 0.25, 0.25},
+  };
+  for (const Mix &mix : mixes) {
+    map.bridge_ratio = mix.bridge;
+    map.gaussian_ratio = mix.gaussian;
+    seed_random(BENCH_SEED);
+    int failures = 0;
+    vector<double> times;
+    for (int i = 0; i < NARROW_RUNS; i++) {
+      auto start_time = chrono::steady_clock::now();
+      auto deadline = start_time + chrono::milliseconds(NARROW_BUDGET_MS);
+      PlanResult plan = Planner::RRT_connect(&start, &goal, map, deadline);
+      failures += plan.converged ? 0 : 1;
+      times.push_back(plan.converged ? elapsed_ms(start_time) : NARROW_BUDGET_MS);
+    }
+    nth_element(times.begin(), times.begin() + NARROW_RUNS / 2, times.end());
+    report(name + "." + mix.name + ".fail", (double) failures / NARROW_RUNS,
+           FAILURE_TOLERANCE);
+    report_time(name + "." + mix.name + ".solve", times[NARROW_RUNS / 2]);
+  }
+  map.bridge_ratio = 0;
+  map.gaussian_ratio = 0;
+}
+
+/**
+ * @brief Grows an Informed RRT* tree for a fixed number of iterations in a
+ * configuration space other than the planar Point one, so that the planner
+ * templates are compiled and run for it. Reports the time and final cost,
+ * or fails the run if no path is found.
+ *
+ * @param name Prefix of the figures.
+ * @param space A configuration space.
+ * @param start Starting configuration.
+ * @param goal Target configuration.
+ * @param num_iterations Samples to draw.
+ * @return Void.
+ */
+template <int D, typename Scalar>
+void bench_config_space(const string &name, Config_Space<D, Scalar> &space,
+                        PointT<D, Scalar> start, PointT<D, Scalar> goal,
+                        int num_iterations) {
+  if (!space.is_freespace(start) || !space.is_freespace(goal)) {
+    cerr << name << ": start or goal is not in free space" << endl;
+    exit(1);
+  }
+  double best_ms = 1e18;
+  double cost = 0;
+  vector<Cost_Sample> curve;
+  for (int r = 0; r < REPEATS; r++) {
+    seed_random(BENCH_SEED);
+    auto start_time = chrono::steady_clock::now();
+    PlanResultT<D, Scalar> plan = Planner::RRT_star_informed(&start, &goal, space,
+                                                             num_iterations, curve);
+    best_ms = min(best_ms, elapsed_ms(start_time));
+    if (!plan.converged || curve.empty()) {
+      cerr << name << ": no path found" << endl;
+      exit(1);
+    }
+    cost = curve.back().cost;
+  }
+  report_time(name + ".star", best_ms);
+  report(name + ".star.cost", cost, COST_TOLERANCE);
+}
+
+/**
+ * @brief Reads a baseline file of lines "name value tolerance". Lines that
+ * are blank or start with # are skipped.
+ *
+ * @param filename The file to read, missing files give an empty baseline.
+ * @return Baseline figures by name.
+ */
+map<string, Metric> read_baseline(const string &filename) {
+  map<string, Metric> baseline;
+  ifstream in(filename);
+  string line;
+  while (getline(in, line)) {
+    size_t first = line.find_first_not_of(" \t\r");
+    if (first == string::npos || line[first] == '#') { continue; }
+    istringstream fields(line);
+    Metric m;
+    if (fields >> m.name >> m.value >> m.tolerance) { baseline[m.name] = m; }
+  }
+  return baseline;
+}
+
+/**
+ * @brief Largest value within the tolerance of a baseline figure.
+ *
+ * @param base Baseline figure.
+ * @return Limit the measured value may reach.
+ */
+double limit(const Metric &base) {
+  const string &tol = base.tolerance;
+  if (!tol.empty() && tol.back() == '%') {
+    return base.value * (1 + atof(tol.c_str()) / 100);
+  }
+  size_t sd = tol.find("sd/");
+  if (sd != string::npos) {
+    /* A fraction of 0 still has the spread of one trial in N */
+    double trials = atof(tol.c_str() + sd + 3);
+    double p = max(base.value, 1 / trials);
+    return base.value + atof(tol.c_str()) * sqrt(p * (1 - p) / trials);
+  }
+  return base.value + atof(tol.c_str());
+}
+
+/**
+ * @brief Checks a figure against the baseline.
+ *
+ * @param m Measured figure.
+ * @param baseline Baseline figures by name.
+ * @return True if the baseline has the figure and m is beyond its tolerance.
+ */
+bool regressed(const Metric &m, const map<string, Metric> &baseline) {
+  auto it = baseline.find(m.name);
+  return it != baseline.end() && m.value > limit(it->second);
+}
+
+/**
+ * @brief Writes the figures of this run as the new baseline.
+ *
+ * @param filename The file to write.
+ * @param baseline Old baseline, whose tolerances are kept.
+ * @return Void.
+ */
+void write_baseline(const string &filename, const map<string, Metric> &baseline) {
+  ofstream out(filename);
+  out << "# Baseline of ./plan-bench, rewrite with ./plan-bench " << filename
+      << " update" << endl;
+  out << "# name value tolerance (a percentage of value, an amount added to it, or"
+      << endl;
+  out << "# K binomial standard deviations of a fraction of N trials as Ksd/N)" << endl;
+  out << "# Figures named .time are in millionths of the calibration loop" << endl;
+  out << fixed << setprecision(3);
+  for (const Metric &m : metrics) {
+    auto it = baseline.find(m.name);
+    out << m.name << " " << m.value << " "
+        << ((it != baseline.end()) ? it->second.tolerance : m.tolerance) << endl;
+  }
+}
+
+int main(int argc, char *argv[]) {
+  if (argc < 2 || argc > 3) { usage(); }
+  string baseline_file = string(argv[1]);
+  bool update = (argc == 3);
+  if (update && string(argv[2]) != "update") { usage(); }
+
+  double robot_radius = 1;
+  Map map1(robot_radius, "maps/map1.txt");
+  Map map2(robot_radius, "maps/map2.txt");
+  Map large = load_generated_map(
+      generate_map(MAP_CLUTTER, LARGE_OBSTACLES, LARGE_DENSITY, 0, BENCH_SEED), robot_radius);
+  Generated_Map corridors = generate_corridors(NARROW_OBSTACLES, DEFAULT_GAP, 1, BENCH_SEED);
+  Map narrow = load_generated_map(corridors, robot_radius);
+  Generated_Map open_space = generate_map(MAP_OPEN, OPEN_OBSTACLES, 0, 1, BENCH_SEED);
+  Map open_map = load_generated_map(open_space, robot_radius);
+  /* Lines between the cells of a generated map are clear of obstacles */
+  Point corner(large.width - GEN_CELL, large.height - GEN_CELL);
+  Point near_corner = Point(0, 0) - corner + Point(3 * GEN_CELL, 3 * GEN_CELL);
+  /* map1 planned in single precision, and as poses turning a half circle */
+  Config_Space<2, float> map1_float(map1);
+  Config_Space<3, double> map1_se2(map1);
+  PointT<3, double> pose_start(-9, -9, 0);
+  PointT<3, double> pose_goal(9, 9, M_PI);
+
+  vector<function<void()>> scenarios = {
+    [&] { bench_rrt_connect("map1", map1, Point(-9, -9), Point(9, 9), 50); },
+    [&] { bench_rrt_connect("map2", map2, Point(-15, 0), Point(15, 0), 50); },
+    [&] { bench_rrt_connect("large", large, Point(0, 0) - corner, corner, 10); },
+    [&] { bench_rrt_star("map1", map1, Point(-9, -9), Point(9, 9), 3000); },
+    [&] { bench_rrt_star("map2", map2, Point(-15, 0), Point(15, 0), 3000); },
+    [&] { bench_rrt_star("large", large, Point(0, 0) - corner, near_corner, 3000); },
+    [&] { bench_config_space("map1.float", map1_float, PointT<2, float>(-9, -9),
+                             PointT<2, float>(9, 9), 3000); },
+    [&] { bench_config_space("map1.se2", map1_se2, pose_start, pose_goal, 3000); },
+    [&] { bench_collisions("map1", map1); },
+    [&] { bench_collisions("large", large); },
+    [&] { bench_sampling("map1", map1); },
+    [&] { bench_sampling("large", large); },
+    [&] { bench_sampling("corridors", narrow); },
+    [&] { bench_kdtree(); },
+    [&] { bench_deadline("large", large, Point(0, 0) - corner, corner,
+                         DEADLINE_MS, DEADLINE_RUNS); },
+    [&] { bench_deadline("open", open_map, open_space.queries[0].first,
+                         open_space.queries[0].second, OPEN_BUDGET_MS, OPEN_RUNS); },
+    [&] { bench_samplers("corridors", narrow, corridors.queries[0].first,
+                         corridors.queries[0].second); },
+  };
+  cerr << "Running scenarios" << endl;
+  for (size_t i = 0; i < scenarios.size(); i++) {
+    run_scenario(i, scenarios[i]);
+  }
+
+  map<string, Metric> baseline = read_baseline(baseline_file);
+  if (update) {
+    write_baseline(baseline_file, baseline);
+    cout << "Wrote " << metrics.size() << " figures to " << baseline_file << endl;
+    return 0;
+  }
+
+  /* Timings are noisy, so a regression has to show up again before it
+   * counts */
+  for (int retry = 0; retry < RETRIES; retry++) {
+    set<int> again;
+    for (const Metric &m : metrics) {
+      if (regressed(m, baseline)) { again.insert(m.scenario); }
+    }
+    if (again.empty()) { break; }
+    cerr << "Running " << again.size() << " scenarios again" << endl;
+    for (int i : again) {
+      run_scenario(i, scenarios[i]);
+    }
+  }
+
+  int regressions = 0;
+  cout << fixed << setprecision(3);
+  cout << left << setw(28) << "# figure" << right << setw(14) << "value"
+       << setw(14) << "baseline" << setw(10) << "change" << "  status" << endl;
+  for (const Metric &m : metrics) {
+    auto it = baseline.find(m.name);
+    cout << left << setw(28) << m.name << right << setw(14) << m.value;
+    if (it == baseline.end()) {
+      cout << setw(14) << "-" << setw(10) << "-" << "  new" << endl;
+      continue;
+    }
+    const Metric &base = it->second;
+    double change = (base.value != 0) ? 100 * (m.value / base.value - 1) : 0;
+    bool slower = regressed(m, baseline);
+    regressions += slower;
+    cout << setw(14) << base.value << setw(9) << setprecision(1) << change << "%"
+         << setprecision(3) << "  " << (slower ? "REGRESSED" : "ok") << endl;
+  }
+
+  if (regressions > 0) {
+    cout << regressions << " of " << metrics.size() << " figures regressed" << endl;
+    return 1;
+  }
+  cout << "All " << metrics.size() << " figures within tolerance" << endl;
+  return 0;
+}
@@ -0,0 +1,65 @@
+/**
+ *  @file daemon.cpp
+ *  @brief Long-running planning daemon. Loads every map given on the command
+ *  line once and answers planning requests on a Unix domain socket using the
+ *  protocol in Service.h. SIGTERM or SIGINT stop it once the requests it
+ *  has queued are answered.
+ *
+ *  @author Shashank Ojha (shashano)
+ *  @author Serris Lew (snlew)
+ *  @author David Bick (dbick)
+ *  @bug No known bugs.
+ */
+
+#include <csignal>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "utils/Map.h"
+
+#include "Service.h"
+
+using namespace std;
+
+/* Service to stop when the daemon is interrupted */
+PlanService *service = NULL;
+
+void usage() {
+  cerr << "Usage: ./plan-daemon SOCKET NUM_WORKERS MAP [MAP ...]" << endl;
+  cerr << "\t Requests refer to maps by their position in the list, from 0." << endl;
+  cerr << "\t NUM_WORKERS of 0 uses one worker per hardware thread." << endl;
+  exit(1);
+}
+
+void on_signal(int sig) {
+  if (service != NULL) { service->request_stop(); }
+}
+
+int main(int argc, char *argv[]) {
+  if (argc < 4) { usage(); }
+  string socket_path = string(argv[1]);
+  int num_workers = atoi(argv[2]);
+  if (num_workers <= 0) { num_workers = max(1u, thread::hardware_concurrency()); }
+
+  double robot_radius = 1;
+  vector<Map> maps;
+  for (int i = 3; i < argc; i++) {
+    maps.push_back(Map(robot_radius, string(argv[i])));
+    cerr << "Map " << (i - 3) << ": " << argv[i] << endl;
+  }
+
+  /* Clients that hang up mid-reply must not kill the daemon */
+  signal(SIGPIPE, SIG_IGN);
+
+  PlanService plan_service(maps, num_workers);
+  service = &plan_service;
+  signal(SIGINT, on_signal);
+  signal(SIGTERM, on_signal);
+
+  cerr << "Serving on " << socket_path << " with " << num_workers << " workers" << endl;
+  plan_service.serve(socket_path);
+  cerr << "Stopped" << endl;
+}
@@ -0,0 +1,100 @@
+/**
+ *  @file dump.cpp
+ *  @brief Reader for plan files written by PlanWriter. Prints a summary line
+ *  per record, or the path and tree of one record as text.
+ *
+ *  @author Shashank Ojha (shashano)
+ *  @author Serris Lew (snlew)
+ *  @author David Bick (dbick)
+ *  @bug No known bugs.
+ */
+
+#include <algorithm>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "utils/PlanFile.h"
+#include "utils/Point.h"
+
+using namespace std;
+
+void usage() {
+  cerr << "Usage: ./plan-dump FILE [RECORD]" << endl;
+  cerr << "\t Without RECORD prints one summary line per record." << endl;
+  cerr << "\t With RECORD prints its path and tree as text." << endl;
+  exit(1);
+}
+
+/**
+ * @brief Prints one line per record: its index, whether it converged,
+ * iterations, path points and cost, tree nodes, depth and total edge length.
+ *
+ * @param file Mapped plan file.
+ * @return Void.
+ */
+void print_summary(const PlanFile &file) {
+  cout << "# record converged iterations path_points path_cost nodes depth tree_length" << endl;
+  vector<int> depth;
+  for (size_t r = 0; r < file.records.size(); r++) {
+    const Plan_Record &rec = file.records[r];
+    int num_nodes = rec.header->num_nodes;
+
+    /* Parents come first, so one pass finds every depth */
+    depth.assign(num_nodes, 0);
+    int max_depth = 0;
+    double tree_length = 0;
+    for (int i = 0; i < num_nodes; i++) {
+      int parent = rec.parents[i];
+      if (parent < 0) { continue; }
+      depth[i] = depth[parent] + 1;
+      max_depth = max(max_depth, depth[i]);
+      tree_length += rec.costs[i] - rec.costs[parent];
+    }
+
+    cout << r << " " << rec.header->converged << " " << rec.header->iterations << " "
+         << rec.header->num_path << " " << rec.header->path_cost << " "
+         << num_nodes << " " << max_depth << " " << tree_length << endl;
+  }
+}
+
+/**
+ * @brief Prints the path of a record and then its tree, one node per line.
+ *
+ * @param rec Record to print.
+ * @return Void.
+ */
+void print_record(const Plan_Record &rec) {
+  cout << "# path " << rec.header->num_path << " points, cost "
+       << rec.header->path_cost << endl;
+  for (uint32_t i = 0; i < rec.header->num_path; i++) {
+    cout << rec.path[i].x << " " << rec.path[i].y << endl;
+  }
+  cout << "# tree " << rec.header->num_nodes << " nodes: x y parent cost" << endl;
+  for (uint32_t i = 0; i < rec.header->num_nodes; i++) {
+    cout << rec.nodes[i].x << " " << rec.nodes[i].y << " " << rec.parents[i]
+         << " " << rec.costs[i] << endl;
+  }
+}
+
+int main(int argc, char *argv[]) {
+  if (argc < 2 || argc > 3) { usage(); }
+  string filename = string(argv[1]);
+  PlanFile file(filename);
+  cout << fixed << setprecision(3);
+
+  if (argc == 2) {
+    print_summary(file);
+    return 0;
+  }
+
+  size_t r = atoi(argv[2]);
+  if (r >= file.records.size()) {
+    cerr << argv[1] << " has " << file.records.size() << " records" << endl;
+    return 1;
+  }
+  print_record(file.records[r]);
+  return 0;
+}
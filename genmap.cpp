@@ -0,0 +1,69 @@
+/**
+ *  @file genmap.cpp
+ *  @brief Writes a procedurally generated map, and optionally start/goal
+ *  queries on it in the format read by plan-batch.
+ *
+ *  @author Shashank Ojha (shashano)
+ *  @author Serris Lew (snlew)
+ *  @author David Bick (dbick)
+ *  @bug No known bugs.
+ */
+
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <string>
+
+#include "utils/MapGen.h"
+
+using namespace std;
+
+#define DEFAULT_NUM_QUERIES 10
+
+void usage() {
+  cerr << "Usage: ./plan-genmap KIND NUM_OBSTACLES SEED MAP [QUERIES] [NUM_QUERIES] "
+       << "[DENSITY|GAP]" << endl;
+  cerr << "\t KIND is clutter, maze, corridors or open" << endl;
+  cerr << "\t QUERIES gets NUM_QUERIES start/goal pairs, default "
+       << DEFAULT_NUM_QUERIES << ", - to skip" << endl;
+  cerr << "\t DENSITY is the fraction clutter covers, default " << DEFAULT_DENSITY << endl;
+  cerr << "\t GAP is the door width of corridors, default " << DEFAULT_GAP << endl;
+  exit(1);
+}
+
+/**
+ * @brief Parses the name of a kind of map.
+ *
+ * @param name Name given on the command line.
+ * @return One of the MAP_ kinds, or -1 if unknown.
+ */
+int parse_kind(const string &name) {
+  if (name == "clutter") { return MAP_CLUTTER; }
+  if (name == "maze") { return MAP_MAZE; }
+  if (name == "corridors") { return MAP_CORRIDORS; }
+  if (name == "open") { return MAP_OPEN; }
+  return -1;
+}
+
+int main(int argc, char *argv[]) {
+  if (argc < 5 || argc > 8) { usage(); }
+  int kind = parse_kind(string(argv[1]));
+  if (kind < 0) { usage(); }
+  int num_obstacles = atoi(argv[2]);
+  unsigned seed = strtoul(argv[3], NULL, 10);
+  string map_file = string(argv[4]);
+  string query_file = (argc > 5) ? string(argv[5]) : "-";
+  int num_queries = (argc > 6) ? atoi(argv[6]) : DEFAULT_NUM_QUERIES;
+  double param = (argc > 7) ? atof(argv[7]) : 0;
+  if (query_file == "-") { num_queries = 0; }
+
+  Generated_Map map = generate_map(kind, num_obstacles, param, num_queries, seed);
+  map.write(map_file);
+  if (num_queries > 0) { map.write_queries(query_file); }
+
+  cout << fixed << setprecision(3);
+  cout << map_file << ": " << map.obstacles.size() << " obstacles, "
+       << 2 * map.width << " x " << 2 * map.height << ", density "
+       << map.density() << ", " << map.queries.size() << " queries" << endl;
+  return 0;
+}
@@ -0,0 +1,200 @@
+/**
+ *  @file loadgen.cpp
+ *  @brief Load generator for the planning daemon. Runs a number of
+ *  concurrent clients, each on its own connection sending its next request
+ *  as soon as the last reply arrives, and reports throughput and the
+ *  distribution of end-to-end latency.
+ *
+ *  @author Shashank Ojha (shashano)
+ *  @author Serris Lew (snlew)
+ *  @author David Bick (dbick)
+ *  @bug No known bugs.
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <unistd.h>
+
+#include "Service.h"
+
+#define MS 1000
+
+using namespace std;
+
+/* What one client saw */
+struct Client_Stats {
+  vector<double> latency_ms;
+  vector<double> queue_ms;
+  int status_counts[PLAN_EXPIRED + 1];
+  bool failed;
+};
+
+void usage() {
+  cerr << "Usage: ./plan-loadgen SOCKET QUERIES CLIENTS REQUESTS [ALGO] [BUDGET_MS] [MAP] [SEED]"
+       << endl;
+  cerr << "\t QUERIES has one query per line: xs ys xt yt, used round robin." << endl;
+  cerr << "\t CLIENTS connections send REQUESTS requests between them." << endl;
+  cerr << "\t Algo is 0 for RRT-Connect, 1 for anytime RRT-Star and 2 for "
+       << "anytime bidirectional RRT-Star." << endl;
+  cerr << "\t Request i is seeded with SEED + i, SEED of 0 lets the daemon pick." << endl;
+  exit(1);
+}
+
+/**
+ * @brief Reads queries in the format of plan-batch.
+ *
+ * @param filename Query file.
+ * @return Start and goal of every query.
+ */
+vector<pair<Point, Point>> read_queries(const string &filename) {
+  vector<pair<Point, Point>> queries;
+  ifstream infile(filename);
+  string line;
+  while (getline(infile, line)) {
+    size_t first = line.find_first_not_of(" \t\r");
+    if (first == string::npos || line[first] == '#') { continue; }
+    istringstream fields(line);
+    double xs, ys, xt, yt;
+    if (fields >> xs >> ys >> xt >> yt) {
+      queries.push_back({Point(xs, ys), Point(xt, yt)});
+    }
+  }
+  return queries;
+}
+
+/**
+ * @brief Sends requests one at a time on its own connection and times each
+ * one until its reply has been read in full.
+ *
+ * @return Void.
+ */
+void run_client(const string &socket_path, const vector<pair<Point, Point>> &queries,
+                atomic<int> &next, int num_requests, Plan_Request base,
+                Client_Stats &stats) {
+  stats.failed = false;
+  int fd = connect_service(socket_path);
+  if (fd < 0) {
+    stats.failed = true;
+    return;
+  }
+
+  vector<double> coords;
+  for (int i = next++; i < num_requests; i = next++) {
+    const pair<Point, Point> &query = queries[i % queries.size()];
+    Plan_Request request = base;
+    request.id = i;
+    request.seed = (base.seed == 0) ? 0 : base.seed + i;
+    request.start_x = query.first.x;
+    request.start_y = query.first.y;
+    request.goal_x = query.second.x;
+    request.goal_y = query.second.y;
+
+    auto sent = chrono::steady_clock::now();
+    Plan_Reply_Header reply;
+    if (!write_full(fd, &request, sizeof(request)) ||
+        !read_full(fd, &reply, sizeof(reply))) {
+      stats.failed = true;
+      break;
+    }
+    coords.resize(2 * reply.num_points);
+    if (!read_full(fd, coords.data(), coords.size() * sizeof(double))) {
+      stats.failed = true;
+      break;
+    }
+    chrono::duration<double, milli> latency = chrono::steady_clock::now() - sent;
+
+    stats.latency_ms.push_back(latency.count());
+    stats.queue_ms.push_back(reply.queue_ms);
+    if (0 <= reply.status && reply.status <= PLAN_EXPIRED) {
+      stats.status_counts[reply.status] += 1;
+    }
+  }
+  close(fd);
+}
+
+/**
+ * @brief Looks up a percentile of sorted data.
+ *
+ * @param sorted Data in increasing order, not empty.
+ * @param q Fraction between 0 and 1.
+ * @return Smallest value with at least q of the data at or below it.
+ */
+double percentile(const vector<double> &sorted, double q) {
+  size_t i = (size_t) ceil(q * sorted.size());
+  return sorted[min(sorted.size() - 1, (i == 0) ? 0 : i - 1)];
+}
+
+int main(int argc, char *argv[]) {
+  if (argc < 5 || argc > 9) { usage(); }
+  string socket_path = string(argv[1]);
+  vector<pair<Point, Point>> queries = read_queries(string(argv[2]));
+  int num_clients = atoi(argv[3]);
+  int num_requests = atoi(argv[4]);
+  int algo = (argc > 5) ? atoi(argv[5]) : PLAN_RRT_CONNECT;
+  double budget_ms = (argc > 6) ? atof(argv[6]) : 1000;
+  int map = (argc > 7) ? atoi(argv[7]) : 0;
+  uint32_t seed = (argc > 8) ? strtoul(argv[8], NULL, 10) : 0;
+  if (queries.empty() || num_clients <= 0 || num_requests <= 0 || budget_ms <= 0) {
+    usage();
+  }
+
+  Plan_Request base = {PLAN_MAGIC, 0, (uint16_t) map, (uint8_t) algo, 0,
+                       (uint32_t) (budget_ms * MS), seed, 0, 0, 0, 0, 0};
+  vector<Client_Stats> stats(num_clients, Client_Stats{{}, {}, {0}, false});
+  vector<thread> clients;
+  atomic<int> next(0);
+
+  auto begin = chrono::steady_clock::now();
+  for (int c = 0; c < num_clients; c++) {
+    clients.push_back(thread(run_client, cref(socket_path), cref(queries), ref(next),
+                             num_requests, base, ref(stats[c])));
+  }
+  for (thread &t : clients) {
+    t.join();
+  }
+  chrono::duration<double> elapsed = chrono::steady_clock::now() - begin;
+
+  vector<double> latency, queue;
+  int status_counts[PLAN_EXPIRED + 1] = {0};
+  int failed = 0;
+  for (const Client_Stats &s : stats) {
+    latency.insert(latency.end(), s.latency_ms.begin(), s.latency_ms.end());
+    queue.insert(queue.end(), s.queue_ms.begin(), s.queue_ms.end());
+    for (int i = 0; i <= PLAN_EXPIRED; i++) {
+      status_counts[i] += s.status_counts[i];
+    }
+    failed += s.failed;
+  }
+  if (latency.empty()) {
+    cerr << "No replies from " << socket_path << endl;
+    return 1;
+  }
+  sort(latency.begin(), latency.end());
+  sort(queue.begin(), queue.end());
+
+  cout << latency.size() << " replies from " << num_clients << " clients in "
+       << elapsed.count() << " s (" << latency.size() / elapsed.count() << " plans/s)" << endl;
+  cout << "Status: " << status_counts[PLAN_OK] << " ok, "
+       << status_counts[PLAN_PARTIAL] << " partial, "
+       << status_counts[PLAN_INVALID] << " invalid, "
+       << status_counts[PLAN_EXPIRED] << " expired" << endl;
+  cout << "Latency (ms): p50 " << percentile(latency, 0.5) << ", p90 "
+       << percentile(latency, 0.9) << ", p99 " << percentile(latency, 0.99)
+       << ", max " << latency.back() << endl;
+  cout << "Queue Time (ms): p50 " << percentile(queue, 0.5) << ", p99 "
+       << percentile(queue, 0.99) << ", max " << queue.back() << endl;
+  if (failed > 0) {
+    cout << failed << " clients lost their connection" << endl;
+  }
+  return (failed > 0) ? 1 : 0;
+}
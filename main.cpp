@@ -2,13 +2,17 @@
 #include <iostream>
 #include <vector>
 #include <ctime>
+#include <chrono>
+#include <thread>
 
 #include "utils/Graph.h"
 #include "utils/KDTree.h"
 #include "utils/Map.h"
 #include "utils/Obstacle.h"
 #include "utils/Point.h"
+#include "utils/Random.h"
 #include "utils/Search.h"
+#include "utils/TreeStream.h"
 
 
 #include "Planner.h"
@@ -17,6 +21,13 @@
 #define MS 1000
 #define RRT_CONNECT 0
 #define RRT_STAR 1
+#define RRT_STAR_INFORMED 2
+#define RRT_STAR_CONNECT 3
+
+/* The live view can fall a whole plan behind without dropping changes */
+#define LIVE_CAPACITY (1 << 16)
+/* Replays are paced by the viewer draining this many changes per frame */
+#define REPLAY_CAPACITY 256
 
 using namespace std;
 string DEFAULT_MAP = "maps/map2.txt";
@@ -27,10 +38,21 @@ Color red = {1, 0, 0};
 Color blue = {0, 0, 1};
 Color green = {0, 1, 0};
 
+/* How the plan is shown */
+#define SHOW_RESULT 0 /* Plan, then draw the finished tree */
+#define SHOW_LIVE 1   /* Draw the tree as it grows */
+#define SHOW_REPLAY 2 /* Draw a recorded tree stream */
+int show = SHOW_RESULT;
+string stream_file;
+
 void usage() {
-  cout << "Usage: ./plan [FILENAME] [ALGO]" << endl;
+  cout << "Usage: ./plan [FILENAME] [ALGO] [live]" << endl;
+  cout << "       ./plan [FILENAME] replay [STREAM]" << endl;
   cout << "\t Maps are in maps/ folder." << endl;
-  cout << "\t Algo is 0 for RRT-Connect and 1 for RRT-Star." << endl;
+  cout << "\t Algo is 0 for RRT-Connect, 1 for RRT-Star, 2 for anytime "
+       << "Informed RRT-Star and 3 for bidirectional RRT-Star." << endl;
+  cout << "\t live draws the tree while it grows." << endl;
+  cout << "\t replay draws a tree stream recorded by plan-batch." << endl;
   exit(0);
 }
 
@@ -40,10 +62,16 @@ pair<int, string> parse_args(int argc, char *argv[]) {
 
   if (argc == 1) {
     return {chosen_algo, filename};
-  } else if (argc == 3) {
+  } else if (argc == 4 && string(argv[2]) == "replay") {
+    show = SHOW_REPLAY;
+    stream_file = string(argv[3]);
+    return {chosen_algo, string(argv[1])};
+  } else if (argc == 3 || (argc == 4 && string(argv[3]) == "live")) {
+    show = (argc == 4) ? SHOW_LIVE : SHOW_RESULT;
     filename = string(argv[1]);
     chosen_algo = atoi(argv[2]);
-    if(chosen_algo != RRT_CONNECT && chosen_algo != RRT_STAR) {
+    if(chosen_algo != RRT_CONNECT && chosen_algo != RRT_STAR &&
+       chosen_algo != RRT_STAR_INFORMED && chosen_algo != RRT_STAR_CONNECT) {
       usage();
     }
     return {chosen_algo, filename};
@@ -73,29 +101,227 @@ void results(int n, Point *start, Point *goal, Map &map) {
     vector<double> plan_time;
     vector<double> path_length;
     vector<double> nodes;
+    vector<double> peak_kb;
+    vector<double> bytes_per_node;
     
     for (int i = 0; i < n; i++) {
         time_t start_time = clock();
-        auto plan = Planner::RRT_star(start, goal, map);
+        PlanResult plan = Planner::RRT_star(start, goal, map);
         time_t end_time = clock();
         
         plan_time.push_back((double)(end_time - start_time)/CLOCKS_PER_SEC*MS);
-        path_length.push_back(plan.first.size() * 1.0);
-        nodes.push_back(plan.second.num_vertices * 1.0);
+        path_length.push_back(plan.path.size() * 1.0);
+        nodes.push_back(plan.tree().num_vertices * 1.0);
+        peak_kb.push_back(plan.memory.peak_bytes / 1024.0);
+        bytes_per_node.push_back(plan.peak_bytes_per_node());
     }
     
     cout << "Plan Time (ms): " << mean(plan_time) << " -+ " << stan_dev(plan_time) << endl;
     cout << "Path Length: " << mean(path_length) << " -+ " << stan_dev(path_length) << endl;
     cout << "# Nodes Sampled: " << mean(nodes) << " -+ " << stan_dev(nodes) << endl;
+    cout << "Peak Memory (KiB): " << mean(peak_kb) << " -+ " << stan_dev(peak_kb) << endl;
+    cout << "Peak Bytes per Node: " << mean(bytes_per_node) << " -+ "
+         << stan_dev(bytes_per_node) << endl;
+}
+
+void deadline_results(int n, Point *start, Point *goal, Map &map, double budget_ms) {
+    for (int algo : {RRT_CONNECT, RRT_STAR}) {
+        double worst_overshoot = 0;
+        int converged = 0;
+        for (int i = 0; i < n; i++) {
+            auto deadline = chrono::steady_clock::now() +
+                            chrono::microseconds((long) (budget_ms * MS));
+            PlanResult plan = (algo == RRT_CONNECT)
+                ? Planner::RRT_connect(start, goal, map, deadline)
+                : Planner::RRT_star(start, goal, map, deadline);
+            worst_overshoot = max(worst_overshoot, plan.overshoot_ms);
+            converged += plan.converged;
+        }
+        cout << (algo == RRT_CONNECT ? "RRT-Connect" : "RRT*") << " with "
+             << budget_ms << " ms budget: " << converged << "/" << n
+             << " converged, worst overshoot " << worst_overshoot << " ms" << endl;
+    }
+}
+
+void replan_results(int n, Point *start, Point *goal, Map &map, double step) {
+    auto never = chrono::steady_clock::time_point::max();
+    Replanner replanner(start, goal, map);
+
+    time_t start_time = clock();
+    PlanResult plan = replanner.replan(start, MAX_NODES, never);
+    time_t end_time = clock();
+    double cold_time = (double)(end_time - start_time)/CLOCKS_PER_SEC*MS;
+
+    /* Move the robot step along the path before each replan */
+    vector<double> replan_time;
+    Point robot = *start;
+    for (int i = 0; i < n && plan.converged && plan.path.size() > 1; i++) {
+        Point delta = *plan.path[1] - robot;
+        double d = sqrt(delta.dot(delta));
+        robot = (d <= step) ? *plan.path[1] : robot + delta.scale(step / d);
+
+        start_time = clock();
+        plan = replanner.replan(&robot, MAX_NODES / 40, never);
+        end_time = clock();
+        replan_time.push_back((double)(end_time - start_time)/CLOCKS_PER_SEC*MS);
+    }
+
+    cout << "Cold Plan Time (ms): " << cold_time << endl;
+    cout << "Replan Time (ms): " << mean(replan_time) << " -+ " << stan_dev(replan_time) << endl;
+}
+
+void sampling_results(int n, Map &map) {
+    bool use_decomposition = map.use_decomposition;
+    for (bool decompose : {false, true}) {
+        map.use_decomposition = decompose;
+        map.num_samples = 0;
+        map.num_rejections = 0;
+
+        time_t start_time = clock();
+        for (int i = 0; i < n; i++) {
+            map.sample_freespace();
+        }
+        time_t end_time = clock();
+
+        cout << (decompose ? "Decomposition" : "Rejection") << " Sampling: "
+             << "Rejection Rate " << map.rejection_rate() << ", "
+             << (double)(end_time - start_time)/CLOCKS_PER_SEC*MS << " ms for "
+             << n << " samples" << endl;
+    }
+    map.use_decomposition = use_decomposition;
 }
 
-pair<vector<Point*>, Graph<Point>> get_plan(Point *start, Point *goal, Map &map, int algo) {
+double euclidean(Point *n, Point *target) {
+    return n->dist(*target);
+}
+
+void search_results(int n, Map &map, int num_nodes, double radius) {
+    /* Roadmap of free samples joined to every visible sample nearby */
+    vector<Point*> samples;
+    for (int i = 0; i < num_nodes; i++) {
+        samples.push_back(new Point(map.sample_freespace()));
+    }
+    KDTree tree(samples[0]);
+    for (int i = 1; i < num_nodes; i++) {
+        tree.insert_node(samples[i]);
+    }
+    Graph<Point> roadmap(samples[0]);
+    for (Point *p : samples) {
+        for (Point *q : tree.points_in_radius(p, radius)) {
+            if (p < q && map.is_valid_path(*p, *q)) { roadmap.add_edge(p, q); }
+        }
+    }
+
+    vector<pair<Point*, Point*>> queries;
+    for (int i = 0; i < n; i++) {
+        queries.push_back({samples[thread_rng() % num_nodes], samples[thread_rng() % num_nodes]});
+    }
+
+    time_t start_time = clock();
+    for (auto query : queries) {
+        Search<Point>::a_star(query.first, query.second, roadmap, euclidean);
+    }
+    time_t end_time = clock();
+    double one_off = (double)(end_time - start_time)/CLOCKS_PER_SEC*MS / n;
+
+    start_time = clock();
+    FrozenGraph<Point> frozen = roadmap.freeze();
+    AStar<Point> engine;
+    for (auto query : queries) {
+        engine.search(frozen, frozen.id(query.first), frozen.id(query.second), euclidean);
+    }
+    end_time = clock();
+    double reused = (double)(end_time - start_time)/CLOCKS_PER_SEC*MS / n;
+
+    cout << "Roadmap: " << roadmap.num_vertices << " vertices, "
+         << roadmap.num_edges << " edges" << endl;
+    cout << "A* Query Time (ms): " << one_off << " one-off, " << reused
+         << " with a frozen roadmap and reused engine" << endl;
+    for (Point *p : samples) {
+        delete p;
+    }
+}
+
+void live_results(int n, Point *start, Point *goal, Map &map) {
+    for (bool attached : {false, true}) {
+        /* A recorder drains the stream like the viewer does, minus drawing */
+        Tree_Stream stream(LIVE_CAPACITY);
+        Tree_Recorder *recorder = attached ? new Tree_Recorder(stream, "/dev/null") : NULL;
+        Planner::listener = attached ? &stream : NULL;
+
+        vector<double> plan_time;
+        for (int i = 0; i < n; i++) {
+            auto start_time = chrono::steady_clock::now();
+            PlanResult plan = Planner::RRT_star(start, goal, map);
+            chrono::duration<double, milli> elapsed = chrono::steady_clock::now() - start_time;
+            plan_time.push_back(elapsed.count());
+        }
+
+        Planner::listener = NULL;
+        delete recorder;
+        cout << "Stream " << (attached ? "Attached" : "Detached") << " Plan Time (ms): "
+             << mean(plan_time) << " -+ " << stan_dev(plan_time) << ", "
+             << stream.dropped << " changes dropped" << endl;
+    }
+}
+
+PlanResult get_plan(Point *start, Point *goal, Map &map, int algo) {
   if(algo == RRT_CONNECT) {
     return Planner::RRT_connect(start, goal, map);
   }
+  if(algo == RRT_STAR_INFORMED || algo == RRT_STAR_CONNECT) {
+    vector<Cost_Sample> curve;
+    PlanResult plan = (algo == RRT_STAR_INFORMED)
+        ? Planner::RRT_star_informed(start, goal, map, MAX_NODES, curve)
+        : Planner::RRT_star_connect(start, goal, map, MAX_NODES, curve);
+    cout << "Cost vs Time:" << endl;
+    for (Cost_Sample sample : curve) {
+      cout << "\t" << sample.time_ms << " ms (iteration " << sample.iteration
+           << "): " << sample.cost << endl;
+    }
+    return plan;
+  }
   return Planner::RRT_star(start, goal, map);
 }
 
+void live_example(int argc, char *argv[], Point *start, Point *goal, Map &map,
+                  double robot_radius, int algo) {
+    Tree_Stream *stream = new Tree_Stream((show == SHOW_LIVE) ? LIVE_CAPACITY : REPLAY_CAPACITY);
+
+    Visualizer v;
+    v.init(argc, argv);
+    v.record_background();
+    for (Obstacle obs : map.minkowski) {
+      v.plot_obstacle(obs.convex_hull, red);
+    }
+    for (Obstacle obs : map.obstacles) {
+      v.plot_obstacle(obs.convex_hull, blue);
+    }
+    v.plot_circle(*start, robot_radius, blue);
+    v.plot_point(*goal, blue);
+
+    /* The stream's only producer, while GLUT's loop on this thread drains it */
+    if (show == SHOW_LIVE) {
+      thread([=, &map]() {
+        Planner::listener = stream;
+        PlanResult plan = get_plan(start, goal, map, algo);
+        stream->add_path(plan.path);
+        Planner::listener = NULL;
+      }).detach();
+    } else {
+      vector<Tree_Event> events = read_tree_events(stream_file);
+      thread([=]() {
+        for (const Tree_Event &event : events) {
+          while (!stream->events.push(event)) {
+            this_thread::sleep_for(chrono::milliseconds(1));
+          }
+        }
+      }).detach();
+    }
+
+    v.run_live(*stream, green, green, black);
+}
+
 void example1(int argc, char *argv[], Map &map, double robot_radius, int algo) {
     
     Point *start = new Point(-1, -3);
@@ -105,11 +331,18 @@ void example1(int argc, char *argv[], Map &map, double robot_radius, int algo) {
     cout << "Goal: " << *goal << endl;
     
 //    results(100, start, goal, map);
+//    sampling_results(100000, map);
+//    deadline_results(100, start, goal, map, 5);
+//    replan_results(50, start, goal, map, 0.1);
+//    search_results(200, map, 20000, 0.6);
+//    live_results(50, start, goal, map);
 
-   auto plan = get_plan(start, goal, map, algo);
+   if (show != SHOW_RESULT) {
+     live_example(argc, argv, start, goal, map, robot_radius, algo);
+     return;
+   }
 
-   vector<Point*> path = plan.first;
-   Graph<Point> graph = plan.second;
+   PlanResult plan = get_plan(start, goal, map, algo);
 
    Visualizer v;
    v.init(argc, argv);
@@ -124,8 +357,8 @@ void example1(int argc, char *argv[], Map &map, double robot_radius, int algo) {
      v.plot_obstacle(obs.convex_hull, blue);
    }
 
-   v.plot_graph(graph, green, green);
-   v.plot_trajectory(path, black, black);
+   v.plot_graph(plan.tree().freeze(), green, green);
+   v.plot_trajectory(plan.path, black, black);
    v.plot_circle(*start, robot_radius, blue);
    v.plot_point(*goal, blue);
 
@@ -134,7 +367,7 @@ void example1(int argc, char *argv[], Map &map, double robot_radius, int algo) {
 
 int main(int argc, char *argv[]) {
   /* Set random seed */
-  srand((unsigned) time(0));
+  seed_random((unsigned) time(0));
   double robot_radius = 1;
 
   auto args = parse_args(argc, argv);
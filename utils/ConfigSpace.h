@@ -0,0 +1,213 @@
+/**
+ *  @file ConfigSpace.h
+ *  @brief Defines the configuration space a planner searches over a planar
+ *  Map. Configurations are points in D dimensions, e.g. (x, y) in the plane,
+ *  (x, y, z) in space or (x, y, heading) for a pose, and the map only ever
+ *  sees their projection onto it.
+ *
+ *  NOTE: The implementation is also found in this file instead of a separate
+ *  cpp file. This is necessary for templates. For more information see:
+ *    https://isocpp.org/wiki/faq/templates#templates-defn-vs-decl
+ *
+ *  @author Shashank Ojha (shashano)
+ *  @author Serris Lew (snlew)
+ *  @author David Bick (dbick)
+ *  @bug No known bugs.
+ */
+
+#ifndef __CONFIGSPACE_H
+#define __CONFIGSPACE_H
+
+#include <cmath>
+#include <cstdlib>
+#include <type_traits>
+
+#include "Map.h"
+#include "Point.h"
+#include "Random.h"
+
+using namespace std;
+
+/* Configurations of a round robot on a planar map. project is the hook that
+ * gives the point of the map a configuration occupies, by default its first
+ * two coordinates. The map checks a move between two configurations as the
+ * segment between their projections, which is exact for linear projections.
+ * Coordinates past the first two are sampled uniformly within [lo, hi] and
+ * measured like the others, so headings do not wrap around. */
+template <int D, typename Scalar = double>
+class Config_Space {
+  public:
+    typedef PointT<D, Scalar> Config;
+    typedef Point (*Projection)(const Config &q);
+
+    /* Data */
+    Map &map;
+    Config lo;             /* Bounds of every coordinate, the first two are */
+    Config hi;             /* the map's */
+    Projection projection; /* NULL for the first two coordinates */
+
+    /* Constructors */
+    Config_Space(Map &map);
+    Config_Space(Map &map, const Config &lo, const Config &hi, Projection projection);
+
+    /* Function Prototypes */
+    Point project(const Config &q) const;
+    bool is_freespace(const Config &q) const;
+    bool is_valid_path(const Config &a, const Config &b) const;
+    bool in_bounds(const Config &q) const;
+    Config sample();
+    double volume() const;
+};
+
+/* Volume of the unit ball in D dimensions */
+template <int D>
+double unit_ball_volume() {
+  return pow(M_PI, D / 2.0) / tgamma(D / 2.0 + 1);
+}
+
+/****************************************************************************/
+
+                            /* Implementation */
+
+/****************************************************************************/
+
+/**
+ * @brief Constructor for the space of a map with the default projection.
+ * Coordinates past the first two range over [-pi, pi].
+ *
+ * @param map A map object.
+ * @return Space over map.
+ */
+template <int D, typename Scalar>
+Config_Space<D, Scalar>::Config_Space(Map &map) : map(map) {
+  static_assert(D >= 2, "Configurations need a position on the map");
+  for (int i = 0; i < D; i++) {
+    this->lo[i] = -M_PI;
+    this->hi[i] = M_PI;
+  }
+  this->lo[0] = -map.width;
+  this->hi[0] = map.width;
+  this->lo[1] = -map.height;
+  this->hi[1] = map.height;
+  this->projection = NULL;
+}
+
+/**
+ * @brief Constructor for a space with its own bounds and projection.
+ *
+ * @param map A map object.
+ * @param lo Lower bound of every coordinate.
+ * @param hi Upper bound of every coordinate.
+ * @param projection Point of the map a configuration occupies, NULL for
+ * its first two coordinates.
+ * @return Space over map.
+ */
+template <int D, typename Scalar>
+Config_Space<D, Scalar>::Config_Space(Map &map, const Config &lo, const Config &hi,
+                                      Projection projection)
+  : map(map), lo(lo), hi(hi) {
+  static_assert(D >= 2, "Configurations need a position on the map");
+  this->projection = projection;
+}
+
+/**
+ * @brief Projects a configuration onto the map.
+ *
+ * @param q A configuration.
+ * @return Point of the map that q occupies.
+ */
+template <int D, typename Scalar>
+Point Config_Space<D, Scalar>::project(const Config &q) const {
+  if (this->projection != NULL) { return this->projection(q); }
+  return Point(q.template get<0>(), q.template get<1>());
+}
+
+/**
+ * @brief Checks whether a configuration is free of obstacles.
+ *
+ * @param q A configuration.
+ * @return True if its projection is in free space.
+ */
+template <int D, typename Scalar>
+bool Config_Space<D, Scalar>::is_freespace(const Config &q) const {
+  if constexpr (is_same<Config, Point>::value) {
+    if (this->projection == NULL) { return this->map.is_freespace(q); }
+  }
+  return this->map.is_freespace(project(q));
+}
+
+/**
+ * @brief Checks whether the straight move between two configurations is
+ * free of obstacles.
+ *
+ * @param a A configuration.
+ * @param b A configuration.
+ * @return True if the segment between their projections is free.
+ */
+template <int D, typename Scalar>
+bool Config_Space<D, Scalar>::is_valid_path(const Config &a, const Config &b) const {
+  if constexpr (is_same<Config, Point>::value) {
+    if (this->projection == NULL) { return this->map.is_valid_path(a, b); }
+  }
+  return this->map.is_valid_path(project(a), project(b));
+}
+
+/**
+ * @brief Checks whether a configuration is within the bounds of the space.
+ *
+ * @param q A configuration.
+ * @return True if every coordinate is within [lo, hi].
+ */
+template <int D, typename Scalar>
+bool Config_Space<D, Scalar>::in_bounds(const Config &q) const {
+  for (int i = 0; i < D; i++) {
+    if (q[i] < this->lo[i] || q[i] > this->hi[i]) { return false; }
+  }
+  return true;
+}
+
+/**
+ * @brief Samples a free configuration. With the default projection the
+ * position comes from the map's mix of samplers and the other coordinates
+ * are uniform, otherwise configurations are drawn uniformly until one is
+ * free.
+ *
+ * @return A configuration within bounds and free of obstacles.
+ */
+template <int D, typename Scalar>
+typename Config_Space<D, Scalar>::Config Config_Space<D, Scalar>::sample() {
+  if (this->projection == NULL) {
+    Point p = this->map.sample();
+    if constexpr (is_same<Config, Point>::value) { return p; }
+    Config q;
+    q[0] = p.x;
+    q[1] = p.y;
+    for (int i = 2; i < D; i++) {
+      q[i] = this->lo[i] + (this->hi[i] - this->lo[i]) * random_unit();
+    }
+    return q;
+  }
+  while (true) {
+    Config q;
+    for (int i = 0; i < D; i++) {
+      q[i] = this->lo[i] + (this->hi[i] - this->lo[i]) * random_unit();
+    }
+    if (is_freespace(q)) { return q; }
+  }
+}
+
+/**
+ * @brief Volume of the space, the measure of the region samples come from.
+ *
+ * @return Product of the extents of every coordinate.
+ */
+template <int D, typename Scalar>
+double Config_Space<D, Scalar>::volume() const {
+  double v = 1;
+  for (int i = 0; i < D; i++) {
+    v *= this->hi[i] - this->lo[i];
+  }
+  return v;
+}
+
+#endif /* __CONFIGSPACE_H */
@@ -18,23 +18,44 @@
 #include <iostream>
 #include <unordered_map>
 #include <unordered_set>
+#include <vector>
+
+#include "Memory.h"
 
 using namespace std;
 
 template <typename Node>
 class Graph;
 
+template <typename Node>
+class FrozenGraph;
+
+/* Told about every change to a Graph that it watches, on the thread making
+ * the change. Vertices are only reported through their edges. */
+template <typename Node>
+class Graph_Listener {
+  public:
+    virtual ~Graph_Listener() {}
+
+    /* Function Prototypes */
+    virtual void watching(Node *root) = 0;
+    virtual void edge_added(Node *A, Node *B) = 0;
+    virtual void edge_removed(Node *A, Node *B) = 0;
+};
+
 template<typename Node>
 ostream& operator<< (ostream& os, const Graph<Node>& g);
 
 template <typename Node> 
 class Graph {
   public:
+    typedef counted_set<Node*> Neighbors; /* Memory is counted, see Memory.h */
+
     /* Data */
     int num_vertices;
     int num_edges;
-    unordered_map<Node*, unordered_set<Node*>> adj_list;
-    vector<pair<Node*, Node*>> edges;
+    counted_map<Node*, Neighbors> adj_list;
+    Graph_Listener<Node> *listener; /* NULL if nobody is watching */
 
     /* Constructors */
     Graph(Node *root);
@@ -42,12 +63,58 @@ class Graph {
     /* Function Prototypes */
     void add_edge(Node *A, Node *B);
     void remove_edge(Node *A, Node *B);
-    unordered_set<Node*> get_neighbors(Node *n);
+    void remove_vertex(Node *n);
+    const Neighbors& get_neighbors(Node *n) const;
+    FrozenGraph<Node> freeze() const;
+    void watch(Graph_Listener<Node> *listener, Node *root);
 
     /* Output Stream Definition */
     friend ostream& operator<< <>(ostream& os, const Graph<Node>& g);
 };
 
+/* Weighted edge to a vertex of a FrozenGraph */
+struct Dense_Edge {
+  int to;
+  double cost;
+};
+
+/* Contiguous run of edges, iterable with a range based for loop */
+struct Edge_Range {
+  const Dense_Edge *first;
+  const Dense_Edge *last;
+
+  const Dense_Edge *begin() const { return this->first; }
+  const Dense_Edge *end() const { return this->last; }
+  int size() const { return this->last - this->first; }
+};
+
+/* Immutable snapshot of a Graph in compressed sparse row form. Vertices are
+ * numbered 0 to num_vertices() - 1 and their coordinates are copied into one
+ * array. The edges out of vertex i are edges[offsets[i]] up to
+ * edges[offsets[i + 1]], each with its cost computed once. Every undirected
+ * edge is stored in both directions. */
+template <typename Node>
+class FrozenGraph {
+  public:
+    /* Data */
+    vector<Node*> vertices;  /* Original Node of each id */
+    vector<Node> points;     /* Copy of each Node, in id order */
+    vector<int> offsets;
+    vector<Dense_Edge> edges;
+    unordered_map<Node*, int> ids;
+
+    /* Constructors */
+    FrozenGraph(const Graph<Node> &g);
+
+    /* Function Prototypes */
+    int num_vertices() const;
+    int num_edges() const;
+    int id(Node *n) const;
+    Node* node(int id) const;
+    const Node& point(int id) const;
+    Edge_Range neighbors(int id) const;
+};
+
 /****************************************************************************/
 
                             /* Implementation */
@@ -65,7 +132,22 @@ template <typename Node>
 Graph<Node>::Graph(Node *root) {
   this->num_vertices = 1;
   this->num_edges = 0;
-  this->adj_list[root] = unordered_set<Node*>();
+  this->adj_list[root] = Neighbors();
+  this->listener = NULL;
+}
+
+/**
+ * @brief Starts reporting changes to a listener, after telling it which
+ * vertex the graph grows from. Edges already in the graph are not reported.
+ *
+ * @param listener Listener to report to, or NULL to stop reporting.
+ * @param root Vertex the graph grows from.
+ * @return Void.
+ */
+template <typename Node>
+void Graph<Node>::watch(Graph_Listener<Node> *listener, Node *root) {
+  this->listener = listener;
+  if (listener != NULL) { listener->watching(root); }
 }
 
 /**
@@ -81,19 +163,20 @@ template <typename Node>
 void Graph<Node>::add_edge(Node *A, Node *B) {
   // Add edge from A to B
   if(this->adj_list.find(A) == this->adj_list.end()) {
-    this->adj_list[A] = unordered_set<Node*>();
+    this->adj_list[A] = Neighbors();
     this->num_vertices += 1;
   }
   this->adj_list[A].insert(B);
 
   // Add edge from B to A
   if(this->adj_list.find(B) == this->adj_list.end()) {
-    this->adj_list[B] = unordered_set<Node*>();
+    this->adj_list[B] = Neighbors();
     this->num_vertices += 1;
   }
   this->adj_list[B].insert(A);
 
   this->num_edges += 1;
+  if (this->listener != NULL) { this->listener->edge_added(A, B); }
 }
 
 /**
@@ -117,17 +200,40 @@ void Graph<Node>::remove_edge(Node *A, Node *B) {
   }
 
   this->num_edges -= 1;
+  if (this->listener != NULL) { this->listener->edge_removed(A, B); }
+}
+
+/**
+ * @brief Removes a vertex and all edges incident to it from the graph.
+ *
+ * @param n Pointer to a Node.
+ * @return Void.
+ */
+template <typename Node> 
+void Graph<Node>::remove_vertex(Node *n) {
+  auto it = this->adj_list.find(n);
+  if (it == this->adj_list.end()) { return; }
+
+  for (Node *neighbor : it->second) {
+    this->adj_list[neighbor].erase(n);
+    this->num_edges -= 1;
+    if (this->listener != NULL) { this->listener->edge_removed(n, neighbor); }
+  }
+  this->adj_list.erase(it);
+  this->num_vertices -= 1;
 }
 
 /**
  * @brief Returns the neighbors of the given node.
  *
  * @param n Pointer to a Node.
- * @return Neighbors of that node.
+ * @return Neighbors of that node, valid until the graph changes.
  */
 template <typename Node> 
-unordered_set<Node*> Graph<Node>::get_neighbors(Node *n) {
-  return this->adj_list[n];
+const typename Graph<Node>::Neighbors& Graph<Node>::get_neighbors(Node *n) const {
+  static const Neighbors none;
+  auto it = this->adj_list.find(n);
+  return (it == this->adj_list.end()) ? none : it->second;
 }
 
 /**
@@ -157,4 +263,123 @@ ostream& operator<<(ostream& os, const Graph<Node> &g) {
   return os;
 }
 
+/****************************************************************************/
+
+                        /* Frozen Graph Implementation */
+
+/****************************************************************************/
+
+/**
+ * @brief Freezes the graph into compressed sparse row form.
+ *
+ * @return Snapshot of the graph, unaffected by later changes to it.
+ */
+template <typename Node>
+FrozenGraph<Node> Graph<Node>::freeze() const {
+  return FrozenGraph<Node>(*this);
+}
+
+/**
+ * @brief Numbers the vertices of g and packs its edges with their costs.
+ *
+ * @param g Graph whose Nodes have a dist function.
+ * @return Frozen snapshot of g.
+ */
+template <typename Node>
+FrozenGraph<Node>::FrozenGraph(const Graph<Node> &g) {
+  int num_vertices = 0;
+  int num_half_edges = 0;
+  for (auto &entry : g.adj_list) {
+    if (entry.first == NULL) { continue; } /* Placeholder root of Graph(NULL) */
+    num_vertices += 1;
+    num_half_edges += entry.second.size();
+  }
+
+  this->vertices.reserve(num_vertices);
+  this->points.reserve(num_vertices);
+  this->ids.reserve(num_vertices);
+  for (auto &entry : g.adj_list) {
+    if (entry.first == NULL) { continue; }
+    this->ids[entry.first] = this->vertices.size();
+    this->vertices.push_back(entry.first);
+    this->points.push_back(*entry.first);
+  }
+
+  this->offsets.reserve(num_vertices + 1);
+  this->edges.reserve(num_half_edges);
+  this->offsets.push_back(0);
+  for (Node *from : this->vertices) {
+    for (Node *to : g.adj_list.at(from)) {
+      this->edges.push_back({this->ids[to], from->dist(*to)});
+    }
+    this->offsets.push_back(this->edges.size());
+  }
+}
+
+/**
+ * @brief Number of vertices, which is one more than the largest id.
+ *
+ * @return Number of vertices.
+ */
+template <typename Node>
+int FrozenGraph<Node>::num_vertices() const {
+  return this->vertices.size();
+}
+
+/**
+ * @brief Number of undirected edges.
+ *
+ * @return Number of edges.
+ */
+template <typename Node>
+int FrozenGraph<Node>::num_edges() const {
+  return this->edges.size() / 2;
+}
+
+/**
+ * @brief Looks up the id of a Node.
+ *
+ * @param n Pointer to a Node.
+ * @return Id of n, or -1 if it is not a vertex.
+ */
+template <typename Node>
+int FrozenGraph<Node>::id(Node *n) const {
+  auto it = this->ids.find(n);
+  return (it == this->ids.end()) ? -1 : it->second;
+}
+
+/**
+ * @brief Looks up the original Node with an id.
+ *
+ * @param id A vertex id.
+ * @return Pointer to the Node, owned by whoever owned the Graph.
+ */
+template <typename Node>
+Node* FrozenGraph<Node>::node(int id) const {
+  return this->vertices[id];
+}
+
+/**
+ * @brief Looks up the snapshot of the Node with an id.
+ *
+ * @param id A vertex id.
+ * @return Copy of the Node taken when the graph was frozen.
+ */
+template <typename Node>
+const Node& FrozenGraph<Node>::point(int id) const {
+  return this->points[id];
+}
+
+/**
+ * @brief Returns the edges out of a vertex without copying them.
+ *
+ * @param id A vertex id.
+ * @return Edges with the id of the other end and their cost.
+ */
+template <typename Node>
+Edge_Range FrozenGraph<Node>::neighbors(int id) const {
+  const Dense_Edge *base = this->edges.data();
+  return {base + this->offsets[id], base + this->offsets[id + 1]};
+}
+
 #endif /* __GRAPH_H */
@@ -0,0 +1,239 @@
+/**
+ *  @file IndexedHeap.h
+ *  @brief Defines a d-ary min heap over dense integer ids with decrease-key
+ *
+ *  NOTE: The implementation is also found in this file instead of a separate
+ *  cpp file. This is necessary for templates. For more information see:
+ *    https://isocpp.org/wiki/faq/templates#templates-defn-vs-decl
+ *
+ *  @author Shashank Ojha (shashano)
+ *  @author Serris Lew (snlew)
+ *  @author David Bick (dbick)
+ *  @bug No known bugs.
+ */
+
+#ifndef __INDEXED_HEAP_H
+#define __INDEXED_HEAP_H
+
+#include <algorithm>
+#include <cassert>
+#include <vector>
+
+using namespace std;
+
+/* Min heap of ids in [0, capacity) keyed by a double. Every id is in the
+ * heap at most once and knows its position, so its key can be lowered in
+ * place instead of pushing a duplicate. Arrays are kept between uses. */
+template <int D>
+class IndexedHeap {
+  public:
+    /* Data */
+    vector<int> heap;     /* Ids in heap order */
+    vector<int> position; /* Index of each id in heap, -1 if absent */
+    vector<double> keys;  /* Key of each id, only valid while it is in heap */
+
+    /* Constructors */
+    IndexedHeap();
+
+    /* Function Prototypes */
+    void reserve(int capacity);
+    void clear();
+    bool empty() const;
+    bool contains(int id) const;
+    double key(int id) const;
+    void push(int id, double key);
+    void decrease_key(int id, double key);
+    int pop_min();
+
+  private:
+    void sift_up(int i);
+    void sift_down(int i);
+    void place(int i, int id);
+};
+
+/****************************************************************************/
+
+                            /* Implementation */
+
+/****************************************************************************/
+
+/**
+ * @brief Constructor for an empty heap without room for any id.
+ *
+ * @return Empty heap.
+ */
+template <int D>
+IndexedHeap<D>::IndexedHeap() {
+  static_assert(D >= 2, "A heap needs at least two children per node");
+}
+
+/**
+ * @brief Makes room for ids in [0, capacity). Never shrinks.
+ *
+ * @param capacity Number of ids.
+ * @return Void.
+ */
+template <int D>
+void IndexedHeap<D>::reserve(int capacity) {
+  if ((int) this->position.size() < capacity) {
+    this->position.resize(capacity, -1);
+    this->keys.resize(capacity);
+  }
+}
+
+/**
+ * @brief Empties the heap in time proportional to its size, keeping the
+ * arrays for the next use.
+ *
+ * @return Void.
+ */
+template <int D>
+void IndexedHeap<D>::clear() {
+  for (int id : this->heap) {
+    this->position[id] = -1;
+  }
+  this->heap.clear();
+}
+
+/**
+ * @brief Checks if the heap is empty.
+ *
+ * @return True if there are no ids in the heap.
+ */
+template <int D>
+bool IndexedHeap<D>::empty() const {
+  return this->heap.empty();
+}
+
+/**
+ * @brief Checks if id is in the heap.
+ *
+ * @param id An id below the capacity.
+ * @return True if id is in the heap.
+ */
+template <int D>
+bool IndexedHeap<D>::contains(int id) const {
+  return this->position[id] != -1;
+}
+
+/**
+ * @brief Key of an id in the heap.
+ *
+ * @param id An id in the heap.
+ * @return Its key.
+ */
+template <int D>
+double IndexedHeap<D>::key(int id) const {
+  assert(this->contains(id));
+  return this->keys[id];
+}
+
+/**
+ * @brief Adds an id that is not in the heap yet.
+ *
+ * @param id An id below the capacity.
+ * @param key Its key.
+ * @return Void.
+ */
+template <int D>
+void IndexedHeap<D>::push(int id, double key) {
+  assert(0 <= id && id < (int) this->position.size());
+  assert(!this->contains(id));
+  this->keys[id] = key;
+  this->heap.push_back(id);
+  this->position[id] = this->heap.size() - 1;
+  this->sift_up(this->heap.size() - 1);
+}
+
+/**
+ * @brief Lowers the key of an id in the heap.
+ *
+ * @param id An id in the heap.
+ * @param key New key, no larger than the current one.
+ * @return Void.
+ */
+template <int D>
+void IndexedHeap<D>::decrease_key(int id, double key) {
+  assert(this->contains(id) && key <= this->keys[id]);
+  this->keys[id] = key;
+  this->sift_up(this->position[id]);
+}
+
+/**
+ * @brief Removes the id with the smallest key.
+ *
+ * @return The removed id.
+ */
+template <int D>
+int IndexedHeap<D>::pop_min() {
+  assert(!this->empty());
+  int min_id = this->heap[0];
+  int last = this->heap.back();
+  this->heap.pop_back();
+  this->position[min_id] = -1;
+  if (!this->heap.empty()) {
+    this->place(0, last);
+    this->sift_down(0);
+  }
+  return min_id;
+}
+
+/**
+ * @brief Puts id at index i of the heap.
+ *
+ * @return Void.
+ */
+template <int D>
+void IndexedHeap<D>::place(int i, int id) {
+  this->heap[i] = id;
+  this->position[id] = i;
+}
+
+/**
+ * @brief Moves the id at index i up until its parent is no larger. The id is
+ * held aside and written once at its final index.
+ *
+ * @param i Index in heap.
+ * @return Void.
+ */
+template <int D>
+void IndexedHeap<D>::sift_up(int i) {
+  int id = this->heap[i];
+  double key = this->keys[id];
+  while (i > 0) {
+    int parent = (i - 1) / D;
+    if (this->keys[this->heap[parent]] <= key) { break; }
+    this->place(i, this->heap[parent]);
+    i = parent;
+  }
+  this->place(i, id);
+}
+
+/**
+ * @brief Moves the id at index i down until none of its children is
+ * smaller.
+ *
+ * @param i Index in heap.
+ * @return Void.
+ */
+template <int D>
+void IndexedHeap<D>::sift_down(int i) {
+  int n = this->heap.size();
+  int id = this->heap[i];
+  double key = this->keys[id];
+  while (true) {
+    int first = D * i + 1;
+    if (first >= n) { break; }
+    int last = min(first + D, n);
+    int best = first;
+    for (int c = first + 1; c < last; c++) {
+      if (this->keys[this->heap[c]] < this->keys[this->heap[best]]) { best = c; }
+    }
+    if (this->keys[this->heap[best]] >= key) { break; }
+    this->place(i, this->heap[best]);
+    i = best;
+  }
+  this->place(i, id);
+}
+
+#endif /* __INDEXED_HEAP_H */
@@ -1,7 +1,22 @@
 /**
  *  @file KDTree.h
- *  @brief Defines a KDTree data structure to manage 2D points. It uses
- *  a Node class internally to help it manage it its structure.
+ *  @brief Defines a KDTree data structure to manage points in D dimensions.
+ *  It uses a Node class internally to help it manage it its structure.
+ *
+ *  The dimension a level splits on is a template parameter of the helpers
+ *  that visit it, so every comparison reads a fixed coordinate and the
+ *  depth % D bookkeeping is resolved at compile time.
+ *
+ *  Nodes keep a copy of their point's coordinates, so queries never follow
+ *  the pointer to the point itself. Each time the tree doubles in size it
+ *  is rebuilt balanced into a single array of nodes sorted by the Z-order
+ *  (Morton) code of their points, which puts nodes that are close in space
+ *  close in memory as well. Owners that have to return by a deadline can
+ *  turn the automatic relayout off and run it themselves when there is time.
+ *
+ *  NOTE: The implementation is also found in this file instead of a separate
+ *  cpp file. This is necessary for templates. For more information see:
+ *    https://isocpp.org/wiki/faq/templates#templates-defn-vs-decl
  *
  *  @author Shashank Ojha (shashano)
  *  @author Serris Lew (snlew)
@@ -12,8 +27,17 @@
 #ifndef __KDTREE_H
 #define __KDTREE_H
 
-
+#include <algorithm>
+#include <cfloat>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <iostream>
+#include <limits>
 #include <unordered_set>
+#include <vector>
+
+#include "Memory.h"
 #include "Point.h"
 
 /* Constants for direction of node placement */
@@ -21,37 +45,539 @@
 #define RIGHT 1
 #define EXISTS 0
 
-#define K 2
+/* Trees smaller than this are never laid out again */
+#define RELAYOUT_MIN 1024
 
-class Node
-{
+/* Guess at the time a relayout takes per node, until one has been timed */
+#define RELAYOUT_NS_PER_NODE 300
+
+template <int D, typename Scalar = double>
+class KDTreeT {
   public:
-    /* Data */
-    Point *data;
-    Node *left;
-    Node *right;
+    typedef PointT<D, Scalar> Pt;
 
-    /* Constructors */
-    Node(Point *root);
-    Node(Point *root, Node *left, Node *right);
-    double node_dist(Node *other);
-};
+    class Node
+    {
+      public:
+        /* Data */
+        Pt *data;
+        Pt pos; /* Copy of *data */
+        Node *left;
+        Node *right;
+
+        /* Constructors */
+        Node(Pt *root);
+        Node(Pt *root, Node *left, Node *right);
+
+        /* Nodes made with new are counted, see Memory.h */
+        static void *operator new(size_t size) { return counted_new(size); }
+        static void operator delete(void *p, size_t size) { counted_delete(p, size); }
+    };
 
-class KDTree {
-  public:
     /* Data */
     Node *root;
+    bool auto_relayout; /* False if the owner runs relayout, see relayout_due */
 
     /* Constructors */
-    KDTree(Point *init_pt);
+    KDTreeT(Pt *init_pt);
+    KDTreeT(const KDTreeT &other) = delete;
+    ~KDTreeT();
 
     /* Function Prototypes */
-    bool insert_node(Point *p);
-    Node *find_node(Point *p);
-    Point *nearest_neighbor(Point *p);
-    unordered_set<Point*> points_in_radius(Point *p, double radius);
+    bool insert_node(Pt *p);
+    void insert_nodes(const vector<Pt*> &points);
+    void relayout();
+    void rebuild(const vector<Pt*> &points);
+    bool relayout_due() const;
+    chrono::nanoseconds relayout_estimate() const;
+    bool remove_node(Pt *p);
+    Node *find_node(Pt *p);
+    Pt *nearest_neighbor(Pt *p);
+    Pt *nearest_neighbor(Pt *p, Scalar eps);
+    unordered_set<Pt*> points_in_radius(Pt *p, Scalar radius);
+    vector<Pt*> points_in_box(const Pt &lo, const Pt &hi);
     void print_inorder();
+
+  private:
+    /* Data */
+    counted_vector<Node> pool; /* Nodes placed by the last relayout, in Z-order */
+    size_t num_nodes;
+    size_t laid_out;    /* num_nodes after the last relayout */
+    double relayout_ns_per_node; /* Time the last relayout took per node */
+
+    static constexpr int next(int dim) { return (dim + 1) % D; }
+
+    bool in_pool(Node *node) const;
+    void delete_helper(Node *node);
+    void collect_helper(Node *node, vector<Pt*> &points);
+    template <int Dim> Node *build_helper(vector<uint32_t> &ranks, int lo, int hi);
+    template <int Dim> static Node *find_node_helper(Pt *p, Node *node, int &dir);
+    void insert_median_first(const vector<Pt*> &points, int lo, int hi);
+    template <int Min, int Dim> static Node *find_min_helper(Node *node);
+    template <int Dim> Node *remove_helper(Node *node, Pt *p, bool &found);
+    template <int Dim> static void nearest_neighbor_helper(Node *curr_node,
+                                                           pair<Node*, Scalar> &best_so_far,
+                                                           Pt *test, Scalar scale);
+    template <int Dim> static void points_in_radius_helper(Node *curr_node,
+                                                           unordered_set<Pt*> &within,
+                                                           Pt *test, Scalar radius);
+    template <int Dim> static void points_in_box_helper(Node *curr_node, vector<Pt*> &within,
+                                                        const Pt &lo, const Pt &hi);
+    static void inorder_traversal_helper(Node *node);
 };
 
+typedef KDTreeT<2, double> KDTree;
+
+/* Interleaves the bits of the coordinates of p, scaled to the box [lo, hi],
+ * into its position along the Z-order curve */
+template <int D, typename Scalar>
+uint64_t morton_code(const PointT<D, Scalar> &p, const PointT<D, Scalar> &lo,
+                     const PointT<D, Scalar> &hi) {
+  const int bits = 64 / D;
+  const double cells = (double) (((uint64_t) 1 << bits) - 1);
+  uint64_t cell[D];
+  for (int i = 0; i < D; i++) {
+    double extent = hi[i] - lo[i];
+    double t = (extent > 0) ? (p[i] - lo[i]) / extent : 0;
+    cell[i] = (uint64_t) (min(max(t, 0.0), 1.0) * cells);
+  }
+  uint64_t code = 0;
+  for (int b = bits - 1; b >= 0; b--) {
+    for (int i = 0; i < D; i++) {
+      code = (code << 1) | ((cell[i] >> b) & 1);
+    }
+  }
+  return code;
+}
+
+/****************************************************************************/
+
+                            /* Implementation */
+
+/****************************************************************************/
+
+template <int D, typename Scalar>
+KDTreeT<D, Scalar>::Node::Node(Pt *root) {
+  this->data = root;
+  this->pos = *root;
+  this->left = NULL;
+  this->right = NULL;
+}
+
+template <int D, typename Scalar>
+KDTreeT<D, Scalar>::Node::Node(Pt *root, Node *left, Node *right) {
+  this->data = root;
+  this->pos = *root;
+  this->left = left;
+  this->right = right;
+}
+
+
+template <int D, typename Scalar>
+KDTreeT<D, Scalar>::KDTreeT(Pt *init_pt) {
+  this->root = new Node(init_pt);
+  this->auto_relayout = true;
+  this->num_nodes = 1;
+  this->laid_out = 1;
+  this->relayout_ns_per_node = RELAYOUT_NS_PER_NODE;
+}
+
+/* Nodes in the pool belong to it and must not be deleted one by one */
+template <int D, typename Scalar>
+bool KDTreeT<D, Scalar>::in_pool(Node *node) const {
+  return !this->pool.empty() && this->pool.data() <= node &&
+         node < this->pool.data() + this->pool.size();
+}
+
+template <int D, typename Scalar>
+void KDTreeT<D, Scalar>::delete_helper(Node *node) {
+  if (node == NULL) { return; }
+  delete_helper(node->left);
+  delete_helper(node->right);
+  if (!this->in_pool(node)) { delete node; }
+}
+
+/* The tree only indexes the points, it does not own them */
+template <int D, typename Scalar>
+KDTreeT<D, Scalar>::~KDTreeT() {
+  delete_helper(this->root);
+}
+
+/* Walks down from node to p or to the leaf p would hang off, setting dir to
+ * EXISTS or to the side of that leaf p belongs on */
+template <int D, typename Scalar>
+template <int Dim>
+typename KDTreeT<D, Scalar>::Node *
+KDTreeT<D, Scalar>::find_node_helper(Pt *p, Node *node, int &dir) {
+  if (node->data == p) {
+    dir = EXISTS;
+    return node;
+  }
+  if (p->template get<Dim>() < node->pos.template get<Dim>()) {
+    if (node->left == NULL) {
+      dir = LEFT;
+      return node;
+    }
+    return find_node_helper<next(Dim)>(p, node->left, dir);
+  }
+  if (node->right == NULL) {
+    dir = RIGHT;
+    return node;
+  }
+  return find_node_helper<next(Dim)>(p, node->right, dir);
+}
+
+template <int D, typename Scalar>
+bool KDTreeT<D, Scalar>::insert_node(Pt *p) {
+  if (this->root == NULL) {
+    this->root = new Node(p);
+    this->num_nodes = 1;
+    return true;
+  }
+  int dir;
+  // finds the node or the closest one
+  Node *leaf = find_node_helper<0>(p, this->root, dir);
+  if (dir == EXISTS) {
+    return true;
+  }
+  else {
+    Node *new_leaf = new Node(p);
+    if (dir == LEFT) leaf->left = new_leaf;
+    else if (dir == RIGHT) leaf->right = new_leaf;
+    else return false;
+    this->num_nodes += 1;
+    if (this->auto_relayout && this->relayout_due()) {
+      this->relayout();
+    }
+    return true;
+  }
+}
+
+/* Inserts points[lo, hi) middle first so a run of nearby points does not
+ * turn into one long branch */
+template <int D, typename Scalar>
+void KDTreeT<D, Scalar>::insert_median_first(const vector<Pt*> &points, int lo, int hi) {
+  if (lo >= hi) { return; }
+  int mid = lo + (hi - lo) / 2;
+  this->insert_node(points[mid]);
+  this->insert_median_first(points, lo, mid);
+  this->insert_median_first(points, mid + 1, hi);
+}
+
+/* Points laid along a line should be passed in order along it */
+template <int D, typename Scalar>
+void KDTreeT<D, Scalar>::insert_nodes(const vector<Pt*> &points) {
+  this->insert_median_first(points, 0, points.size());
+}
+
+template <int D, typename Scalar>
+void KDTreeT<D, Scalar>::collect_helper(Node *node, vector<Pt*> &points) {
+  if (node == NULL) { return; }
+  points.push_back(node->data);
+  collect_helper(node->left, points);
+  collect_helper(node->right, points);
+}
+
+/* Builds a balanced tree over the pool nodes ranks[lo, hi), splitting at the
+ * median along Dim. Values equal to the median go right, as in insertion. */
+template <int D, typename Scalar>
+template <int Dim>
+typename KDTreeT<D, Scalar>::Node *
+KDTreeT<D, Scalar>::build_helper(vector<uint32_t> &ranks, int lo, int hi) {
+  if (lo >= hi) { return NULL; }
+  counted_vector<Node> &pool = this->pool;
+  auto less = [&pool](uint32_t a, uint32_t b) {
+    return pool[a].pos.template get<Dim>() < pool[b].pos.template get<Dim>();
+  };
+  int mid = lo + (hi - lo) / 2;
+  nth_element(ranks.begin() + lo, ranks.begin() + mid, ranks.begin() + hi, less);
+  Scalar split = pool[ranks[mid]].pos.template get<Dim>();
+  int first = partition(ranks.begin() + lo, ranks.begin() + mid, [&](uint32_t a) {
+    return pool[a].pos.template get<Dim>() < split;
+  }) - ranks.begin();
+  swap(ranks[first], ranks[mid]);
+
+  Node *node = &pool[ranks[first]];
+  node->left = build_helper<next(Dim)>(ranks, lo, first);
+  node->right = build_helper<next(Dim)>(ranks, first + 1, hi);
+  return node;
+}
+
+/* Rebuilds the tree balanced, with its nodes stored contiguously in the
+ * Z-order of their points, so that queries around a point mostly touch
+ * nearby memory. Points themselves do not move. */
+template <int D, typename Scalar>
+void KDTreeT<D, Scalar>::relayout() {
+  vector<Pt*> points;
+  points.reserve(this->num_nodes);
+  collect_helper(this->root, points);
+  this->rebuild(points);
+}
+
+/* Replaces the points of the tree with the given distinct points, laid out
+ * as by relayout */
+template <int D, typename Scalar>
+void KDTreeT<D, Scalar>::rebuild(const vector<Pt*> &points) {
+  auto start_time = chrono::steady_clock::now();
+  if (points.empty()) {
+    delete_helper(this->root);
+    this->pool.clear();
+    this->root = NULL;
+    this->num_nodes = 0;
+    this->laid_out = 0;
+    return;
+  }
+
+  Pt lo = *points[0];
+  Pt hi = *points[0];
+  for (Pt *p : points) {
+    for (int i = 0; i < D; i++) {
+      lo[i] = min(lo[i], (*p)[i]);
+      hi[i] = max(hi[i], (*p)[i]);
+    }
+  }
+  vector<pair<uint64_t, Pt*>> order;
+  order.reserve(points.size());
+  for (Pt *p : points) {
+    order.push_back({morton_code(*p, lo, hi), p});
+  }
+  sort(order.begin(), order.end());
+
+  counted_vector<Node> pool;
+  pool.reserve(order.size());
+  for (auto &entry : order) {
+    pool.push_back(Node(entry.second));
+  }
+  delete_helper(this->root);
+  this->pool.swap(pool);
+
+  vector<uint32_t> ranks(this->pool.size());
+  for (size_t i = 0; i < ranks.size(); i++) { ranks[i] = i; }
+  this->root = build_helper<0>(ranks, 0, ranks.size());
+  this->num_nodes = this->pool.size();
+  this->laid_out = this->num_nodes;
+
+  chrono::duration<double, nano> elapsed = chrono::steady_clock::now() - start_time;
+  this->relayout_ns_per_node = elapsed.count() / this->num_nodes;
+}
+
+/* Doubling keeps the cost of relayouts to O(log n) per insertion */
+template <int D, typename Scalar>
+bool KDTreeT<D, Scalar>::relayout_due() const {
+  return this->num_nodes >= RELAYOUT_MIN && this->num_nodes >= 2 * this->laid_out;
+}
+
+/* Time the next relayout should take, scaled from the last one */
+template <int D, typename Scalar>
+chrono::nanoseconds KDTreeT<D, Scalar>::relayout_estimate() const {
+  return chrono::nanoseconds((long long) (this->relayout_ns_per_node * this->num_nodes));
+}
+
+/* Returns the node with the smallest value in dimension Min */
+template <int D, typename Scalar>
+template <int Min, int Dim>
+typename KDTreeT<D, Scalar>::Node *KDTreeT<D, Scalar>::find_min_helper(Node *node) {
+  if (node == NULL) { return NULL; }
+  Node *best = node;
+  Node *left = find_min_helper<Min, next(Dim)>(node->left);
+  if (left != NULL && left->pos.template get<Min>() < best->pos.template get<Min>()) {
+    best = left;
+  }
+  if (Dim == Min) { return best; } /* Right side is never smaller */
+  Node *right = find_min_helper<Min, next(Dim)>(node->right);
+  if (right != NULL && right->pos.template get<Min>() < best->pos.template get<Min>()) {
+    best = right;
+  }
+  return best;
+}
+
+/* Removes p from the subtree at node and returns the new subtree root. The
+ * removed node is replaced by the minimum of its right subtree along the
+ * splitting dimension, or of its left subtree which then becomes the right
+ * one, so smaller values stay left and ties stay right as in insertion. */
+template <int D, typename Scalar>
+template <int Dim>
+typename KDTreeT<D, Scalar>::Node *
+KDTreeT<D, Scalar>::remove_helper(Node *node, Pt *p, bool &found) {
+  if (node == NULL) { return NULL; }
+
+  if (node->data == p) {
+    found = true;
+    if (node->right != NULL) {
+      Node *min_node = find_min_helper<Dim, next(Dim)>(node->right);
+      node->data = min_node->data;
+      node->pos = min_node->pos;
+      node->right = remove_helper<next(Dim)>(node->right, node->data, found);
+    } else if (node->left != NULL) {
+      Node *min_node = find_min_helper<Dim, next(Dim)>(node->left);
+      node->data = min_node->data;
+      node->pos = min_node->pos;
+      node->right = remove_helper<next(Dim)>(node->left, node->data, found);
+      node->left = NULL;
+    } else {
+      if (!this->in_pool(node)) { delete node; }
+      return NULL;
+    }
+  } else if (p->template get<Dim>() < node->pos.template get<Dim>()) {
+    node->left = remove_helper<next(Dim)>(node->left, p, found);
+  } else {
+    node->right = remove_helper<next(Dim)>(node->right, p, found);
+  }
+  return node;
+}
+
+template <int D, typename Scalar>
+bool KDTreeT<D, Scalar>::remove_node(Pt *p) {
+  bool found = false;
+  this->root = remove_helper<0>(this->root, p, found);
+  if (found) { this->num_nodes -= 1; }
+  return found;
+}
+
+template <int D, typename Scalar>
+typename KDTreeT<D, Scalar>::Node *KDTreeT<D, Scalar>::find_node(Pt *p) {
+  if (this->root == NULL) { return NULL; }
+  int dir;
+  Node *leaf = find_node_helper<0>(p, this->root, dir);
+  if (dir == EXISTS) {
+    return leaf;
+  }
+  else {
+    return NULL;
+  }
+}
+
+/* Args
+   curr_node:   The node within the kd-tree that you are comparing with to see
+              which direction to go, also comparing the distance at that node
+   best_so_far: The Node* that is closest to test so far, as well as the
+              corresponding distance
+   test:        The point we are trying to find a neighbor of
+   Dim:         The dimension curr_node splits on
+ */
+template <int D, typename Scalar>
+template <int Dim>
+void KDTreeT<D, Scalar>::nearest_neighbor_helper(Node *curr_node,
+                                                 pair<Node*, Scalar> &best_so_far,
+                                                 Pt *test, Scalar scale) {
+  if (curr_node == NULL) { return; }
+
+  Scalar curr_dist = test->dist(curr_node->pos);
+  if (curr_dist < best_so_far.second) {
+    best_so_far = {curr_node, curr_dist};
+  }
+
+  Scalar boundary_dist = test->template get<Dim>() - curr_node->pos.template get<Dim>();
+  Node *near_side = (boundary_dist < 0) ? curr_node->left : curr_node->right;
+  Node *far_side = (boundary_dist < 0) ? curr_node->right : curr_node->left;
+  nearest_neighbor_helper<next(Dim)>(near_side, best_so_far, test, scale);
+
+  /* have to check opposite side of split if the hypersphere centered at test
+  with radius best_dist / scale crosses the splitting boundary */
+  if (fabs(boundary_dist) * scale < best_so_far.second) {
+    nearest_neighbor_helper<next(Dim)>(far_side, best_so_far, test, scale);
+  }
+}
+
+template <int D, typename Scalar>
+typename KDTreeT<D, Scalar>::Pt *KDTreeT<D, Scalar>::nearest_neighbor(Pt *p) {
+  return nearest_neighbor(p, 0);
+}
+
+/* Approximate nearest neighbor: the point returned is at most (1 + eps)
+ * times farther from p than the true nearest one. Sides of a split are only
+ * searched if they could hold a point that much closer than the best so far,
+ * so larger eps visits fewer nodes. An eps of 0 gives the exact answer. */
+template <int D, typename Scalar>
+typename KDTreeT<D, Scalar>::Pt *KDTreeT<D, Scalar>::nearest_neighbor(Pt *p, Scalar eps) {
+  pair<Node*, Scalar> best_so_far = {NULL, numeric_limits<Scalar>::max()};
+  nearest_neighbor_helper<0>(this->root, best_so_far, p, 1 + eps);
+  if (best_so_far.first == NULL) { return NULL; } /* Empty tree */
+  return best_so_far.first->data;
+}
+
+template <int D, typename Scalar>
+template <int Dim>
+void KDTreeT<D, Scalar>::points_in_radius_helper(Node *curr_node, unordered_set<Pt*> &within,
+                                                 Pt *test, Scalar radius) {
+  if (curr_node == NULL) { return; }
+
+  // Check current node, leaving out the test point itself
+  Scalar curr_dist = test->dist(curr_node->pos);
+  if(curr_dist < radius && curr_node->data != test) {
+    within.insert(curr_node->data);
+  }
+
+  // Check the side of the split test is on first
+  Scalar boundary_dist = test->template get<Dim>() - curr_node->pos.template get<Dim>();
+  Node *near_side = (boundary_dist < 0) ? curr_node->left : curr_node->right;
+  Node *far_side = (boundary_dist < 0) ? curr_node->right : curr_node->left;
+  points_in_radius_helper<next(Dim)>(near_side, within, test, radius);
+
+  /* have to check opposite side of split if the hypersphere centered at test
+  with radius best_dist crosses the splitting boundary */
+  if (fabs(boundary_dist) < radius) {
+    points_in_radius_helper<next(Dim)>(far_side, within, test, radius);
+  }
+}
+
+template <int D, typename Scalar>
+unordered_set<typename KDTreeT<D, Scalar>::Pt*>
+KDTreeT<D, Scalar>::points_in_radius(Pt *p, Scalar radius) {
+  unordered_set<Pt*> within;
+  points_in_radius_helper<0>(this->root, within, p, radius);
+  return within;
+}
+
+template <int D, typename Scalar>
+template <int Dim>
+void KDTreeT<D, Scalar>::points_in_box_helper(Node *curr_node, vector<Pt*> &within,
+                                              const Pt &lo, const Pt &hi) {
+  if (curr_node == NULL) { return; }
+
+  const Pt *p = &curr_node->pos;
+  bool inside = true;
+  for (int i = 0; i < D; i++) {
+    inside = inside && lo[i] <= (*p)[i] && (*p)[i] <= hi[i];
+  }
+  if (inside) {
+    within.push_back(curr_node->data);
+  }
+
+  // Only descend into the sides of the split the box reaches
+  if (lo.template get<Dim>() < p->template get<Dim>()) {
+    points_in_box_helper<next(Dim)>(curr_node->left, within, lo, hi);
+  }
+  if (hi.template get<Dim>() >= p->template get<Dim>()) {
+    points_in_box_helper<next(Dim)>(curr_node->right, within, lo, hi);
+  }
+}
+
+template <int D, typename Scalar>
+vector<typename KDTreeT<D, Scalar>::Pt*>
+KDTreeT<D, Scalar>::points_in_box(const Pt &lo, const Pt &hi) {
+  vector<Pt*> within;
+  points_in_box_helper<0>(this->root, within, lo, hi);
+  return within;
+}
+
+
+template <int D, typename Scalar>
+void KDTreeT<D, Scalar>::inorder_traversal_helper(Node *node) {
+  if (node == NULL)
+    return;
+  inorder_traversal_helper(node->left);
+  cout << *node->data << "\n";
+  inorder_traversal_helper(node->right);
+}
+
+template <int D, typename Scalar>
+void KDTreeT<D, Scalar>::print_inorder()
+{
+  cout << '\n';
+  Node *node = this->root;
+  inorder_traversal_helper(node);
+  cout << '\n';
+}
 
 #endif /* __KDTREE_H */
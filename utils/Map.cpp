@@ -8,12 +8,20 @@
  *  @bug No known bugs.
  */
 
+#include <algorithm>
+#include <cassert>
+#include <cfloat>
+#include <cstdlib>
+#include <math.h>
 #include <vector>
 #include <fstream>
+#include <stdexcept>
 
 #include "Map.h"
 #include "Obstacle.h"
 #include "Point.h"
+#include "Random.h"
+#include "Trace.h"
 
 using namespace std;
 
@@ -27,6 +35,15 @@ Map::Map(const float &robot_radius) {
   this->rad = robot_radius;
   this->num_obstacles = 0;
   this->obstacles = vector<Obstacle>();
+  this->decomposed = false;
+  this->use_decomposition = true;
+  this->gaussian_ratio = 0;
+  this->bridge_ratio = 0;
+  this->sample_sigma = 2 * robot_radius;
+  this->num_samples = 0;
+  this->num_rejections = 0;
+  this->num_point_checks = 0;
+  this->num_path_checks = 0;
 }
 
 /**
@@ -40,6 +57,15 @@ Map::Map(const float &robot_radius, const vector<Obstacle> &obs) {
   this->rad = robot_radius;
   this->num_obstacles = obs.size();
   this->obstacles = vector<Obstacle>(obs);
+  this->decomposed = false;
+  this->use_decomposition = true;
+  this->gaussian_ratio = 0;
+  this->bridge_ratio = 0;
+  this->sample_sigma = 2 * robot_radius;
+  this->num_samples = 0;
+  this->num_rejections = 0;
+  this->num_point_checks = 0;
+  this->num_path_checks = 0;
 }
 
 /**
@@ -79,6 +105,16 @@ Map::Map(const float &robot_radius, const string &filename) {
     this->minkowski.push_back(Obstacle::minkowski_sum(o, this->rad));
     polygon.clear();    
   }
+
+  this->use_decomposition = true;
+  this->gaussian_ratio = 0;
+  this->bridge_ratio = 0;
+  this->sample_sigma = 2 * robot_radius;
+  this->num_samples = 0;
+  this->num_rejections = 0;
+  this->num_point_checks = 0;
+  this->num_path_checks = 0;
+  decompose_freespace();
 }
 
 
@@ -92,6 +128,21 @@ void Map::add_obstacle(const Obstacle &o) {
   this->num_obstacles += 1;
   this->obstacles.push_back(o);
   this->minkowski.push_back(Obstacle::minkowski_sum(o, this->rad));
+  this->decomposed = false; /* Rebuilt lazily on the next sample */
+}
+
+/**
+ * @brief Removes the obstacle at the given index from the map.
+ *
+ * @param index Position of the obstacle in obstacles.
+ * @return Void.
+ */
+void Map::remove_obstacle(int index) {
+  assert(0 <= index && index < this->num_obstacles);
+  this->num_obstacles -= 1;
+  this->obstacles.erase(this->obstacles.begin() + index);
+  this->minkowski.erase(this->minkowski.begin() + index);
+  this->decomposed = false; /* Rebuilt lazily on the next sample */
 }
 
 /**
@@ -102,6 +153,7 @@ void Map::add_obstacle(const Obstacle &o) {
  * @return True if it doesn't collid with any obstacles and false otherwise.
  */
 bool Map::is_freespace(const Point &p) const {
+  this->num_point_checks += 1;
   for(const Obstacle &obs : this->minkowski) {
     if(obs.collides(p)) {
       return false;
@@ -119,10 +171,360 @@ bool Map::is_freespace(const Point &p) const {
  * @return True if it doesn't collid with any obstacles and false otherwise.
  */
 bool Map::is_valid_path(const Point &p1, const Point &p2) const {
+  TRACE_SCOPE("is_valid_path");
+  this->num_path_checks += 1;
   for(const Obstacle &obs : this->minkowski) {
     if(obs.path_collides(p1, p2)) {
       return false;
     }
   }
   return true;
+}
+
+/**
+ * @brief Checks if the given point lies inside the dimensions of the map.
+ *
+ * @param p A point.
+ * @return True if it is inside and false otherwise.
+ */
+bool Map::in_bounds(const Point &p) const {
+  return fabs(p.x) <= this->width && fabs(p.y) <= this->height;
+}
+
+/****************************************************************************/
+
+                        /* Free Space Decomposition */
+
+/****************************************************************************/
+
+/* Vertical extent of one obstacle over a slab. The bottom and top boundaries
+ * are single hull edges because no vertex lies strictly inside the slab. */
+struct SlabSpan {
+  Point lo_a, lo_b; /* Edge bounding the obstacle from below */
+  Point hi_a, hi_b; /* Edge bounding the obstacle from above */
+  double lo_mid, hi_mid;
+};
+
+/**
+ * @brief Evaluates the line through A and B at the given x coordinate.
+ *
+ * @param A First point on line.
+ * @param B Second point on line.
+ * @param x Coordinate to evaluate at.
+ * @return y coordinate of the line at x.
+ */
+double line_at(const Point &A, const Point &B, double x) {
+  return A.y + (B.y - A.y) * (x - A.x) / (B.x - A.x);
+}
+
+/**
+ * @brief Adds the x coordinate of the proper intersection of segments AB and
+ * CD to events if there is one.
+ *
+ * @return Void.
+ */
+void add_crossing(const Point &A, const Point &B, const Point &C,
+                  const Point &D, vector<double> &events) {
+  Point r = B - A;
+  Point s = D - C;
+  double denom = r.cross(s);
+  if (denom == 0) { return; }
+  double t = (C - A).cross(s) / denom;
+  double u = (C - A).cross(r) / denom;
+  if (t > 0 && t < 1 && u > 0 && u < 1) {
+    events.push_back(A.x + t * r.x);
+  }
+}
+
+/**
+ * @brief Adds a triangle to the decomposition if it has positive area.
+ *
+ * @return Void.
+ */
+void add_cell(const Point &A, const Point &B, const Point &C,
+              vector<Point> &cells, vector<double> &cdf) {
+  double area = fabs((B - A).cross(C - A)) / 2;
+  if (area <= 0) { return; }
+  double total = cdf.empty() ? 0 : cdf.back();
+  cells.push_back(A);
+  cells.push_back(B);
+  cells.push_back(C);
+  cdf.push_back(total + area);
+}
+
+/**
+ * @brief Decomposes the free space of the map into triangles so samples can
+ * be drawn directly from it. The map is cut into vertical slabs at every
+ * obstacle vertex and edge crossing so that inside a slab each obstacle is
+ * bounded by one edge from below and one from above and those edges never
+ * cross. The gaps between the merged obstacle spans are trapezoids, which
+ * are split into two triangles each. Maps that need more than
+ * DECOMPOSE_MAX_CELLS cells keep none.
+ *
+ * @return Void.
+ */
+void Map::decompose_freespace() {
+  double x_min = -this->width, x_max = this->width;
+  double y_min = -this->height, y_max = this->height;
+  int n = this->minkowski.size();
+
+  /* Bounding boxes, used to find candidate pairs and the active set */
+  vector<double> lo_x(n), hi_x(n), lo_y(n), hi_y(n);
+  for (int i = 0; i < n; i++) {
+    lo_x[i] = this->minkowski[i].lo.x; hi_x[i] = this->minkowski[i].hi.x;
+    lo_y[i] = this->minkowski[i].lo.y; hi_y[i] = this->minkowski[i].hi.y;
+  }
+
+  vector<int> order(n);
+  for (int i = 0; i < n; i++) { order[i] = i; }
+  sort(order.begin(), order.end(),
+       [&](int a, int b) { return lo_x[a] < lo_x[b]; });
+
+  /* Slab boundaries: vertices, crossings with the map border and crossings
+   * between edges of obstacles whose bounding boxes overlap */
+  vector<double> events = {x_min, x_max};
+  Point corners[4] = {Point(x_min, y_min), Point(x_max, y_min),
+                      Point(x_max, y_max), Point(x_min, y_max)};
+  for (int i = 0; i < n; i++) {
+    const vector<Point> &hull = this->minkowski[i].convex_hull;
+    int m = hull.size();
+    for (int e = 0; e < m; e++) {
+      const Point &A = hull[e];
+      const Point &B = hull[(e+1) % m];
+      events.push_back(A.x);
+      add_crossing(A, B, corners[0], corners[1], events);
+      add_crossing(A, B, corners[3], corners[2], events);
+    }
+  }
+  for (int a = 0; a < n; a++) {
+    int i = order[a];
+    for (int b = a + 1; b < n && lo_x[order[b]] <= hi_x[i]; b++) {
+      int j = order[b];
+      if (lo_y[j] > hi_y[i] || hi_y[j] < lo_y[i]) { continue; }
+      const vector<Point> &P = this->minkowski[i].convex_hull;
+      const vector<Point> &Q = this->minkowski[j].convex_hull;
+      for (size_t e = 0; e < P.size(); e++) {
+        for (size_t f = 0; f < Q.size(); f++) {
+          add_crossing(P[e], P[(e+1) % P.size()],
+                       Q[f], Q[(f+1) % Q.size()], events);
+        }
+      }
+    }
+  }
+  sort(events.begin(), events.end());
+  events.erase(unique(events.begin(), events.end()), events.end());
+
+  this->free_cells.clear();
+  this->free_cdf.clear();
+
+  /* Sweep the slabs left to right keeping the obstacles that span them */
+  vector<int> active;
+  vector<SlabSpan> spans;
+  int next = 0;
+  for (size_t k = 0; k + 1 < events.size(); k++) {
+    double x0 = events[k], x1 = events[k+1];
+    if (x1 <= x_min || x0 >= x_max || x1 - x0 < POINT_EPSILON) { continue; }
+    double xm = (x0 + x1) / 2;
+
+    while (next < n && lo_x[order[next]] < x1) {
+      active.push_back(order[next++]);
+    }
+    active.erase(remove_if(active.begin(), active.end(),
+                           [&](int i) { return hi_x[i] <= x0; }),
+                 active.end());
+
+    spans.clear();
+    for (int i : active) {
+      const vector<Point> &hull = this->minkowski[i].convex_hull;
+      int m = hull.size();
+      SlabSpan span;
+      span.lo_mid = DBL_MAX;
+      span.hi_mid = -DBL_MAX;
+      for (int e = 0; e < m; e++) {
+        const Point &A = hull[e];
+        const Point &B = hull[(e+1) % m];
+        if (min(A.x, B.x) > x0 || max(A.x, B.x) < x1) { continue; }
+        double y = line_at(A, B, xm);
+        if (y < span.lo_mid) { span.lo_mid = y; span.lo_a = A; span.lo_b = B; }
+        if (y > span.hi_mid) { span.hi_mid = y; span.hi_a = A; span.hi_b = B; }
+      }
+      if (span.lo_mid < span.hi_mid) { spans.push_back(span); }
+    }
+    sort(spans.begin(), spans.end(), [](const SlabSpan &a, const SlabSpan &b) {
+      return a.lo_mid < b.lo_mid;
+    });
+
+    /* Walk the merged spans bottom to top emitting the gaps between them */
+    bool floor_is_border = true;
+    Point floor_a, floor_b;
+    double floor_mid = y_min;
+    size_t s = 0;
+    while (true) {
+      bool ceil_is_border = (s == spans.size());
+      double ceil_mid = ceil_is_border ? y_max : spans[s].lo_mid;
+      if (ceil_mid > floor_mid) {
+        double b0 = floor_is_border ? y_min : line_at(floor_a, floor_b, x0);
+        double b1 = floor_is_border ? y_min : line_at(floor_a, floor_b, x1);
+        double t0 = ceil_is_border ? y_max : line_at(spans[s].lo_a, spans[s].lo_b, x0);
+        double t1 = ceil_is_border ? y_max : line_at(spans[s].lo_a, spans[s].lo_b, x1);
+        b0 = max(y_min, min(y_max, b0)); b1 = max(y_min, min(y_max, b1));
+        t0 = max(y_min, min(y_max, t0)); t1 = max(y_min, min(y_max, t1));
+        Point A(x0, b0), B(x1, b1), C(x1, t1), D(x0, t0);
+        add_cell(A, B, C, this->free_cells, this->free_cdf);
+        add_cell(A, C, D, this->free_cells, this->free_cdf);
+      }
+      if (ceil_is_border || floor_mid >= y_max) { break; }
+
+      /* Absorb every span overlapping this one into a single blocked group */
+      const SlabSpan *top = &spans[s];
+      while (s < spans.size() && spans[s].lo_mid <= top->hi_mid) {
+        if (spans[s].hi_mid > top->hi_mid) { top = &spans[s]; }
+        s++;
+      }
+      if (top->hi_mid > floor_mid) {
+        floor_is_border = false;
+        floor_a = top->hi_a;
+        floor_b = top->hi_b;
+        floor_mid = top->hi_mid;
+      }
+    }
+
+    /* Too large to keep, sample_freespace rejects from the whole map instead */
+    if (this->free_cdf.size() > DECOMPOSE_MAX_CELLS) {
+      vector<Point>().swap(this->free_cells);
+      vector<double>().swap(this->free_cdf);
+      break;
+    }
+  }
+
+  this->decomposed = true;
+}
+
+/**
+ * @brief Samples a point uniformly inside the dimensions of the map.
+ *
+ * @param width Map width.
+ * @param height Map height.
+ * @return A point inside the dimensions of the map.
+ */
+Point sample_uniform(float width, float height) {
+  /* -width <= x < width */
+  double x = (random_unit() * 2 * width) - width;
+  /* -height <= y < height */
+  double y = (random_unit() * 2 * height) - height;
+  return Point(x, y);
+}
+
+/**
+ * @brief Samples a point uniformly from the free space of the map. With the
+ * decomposition a cell is picked by binary search over the cumulative areas
+ * and a point drawn uniformly inside it, so no draws are rejected. Otherwise
+ * points are drawn from the whole map until one is free.
+ *
+ * @return A point inside the dimensions of the map and free of obstacles.
+ */
+Point Map::sample_freespace() {
+  if (this->use_decomposition && !this->decomposed) {
+    decompose_freespace();
+  }
+
+  while (true) {
+    Point p;
+    if (this->use_decomposition && !this->free_cdf.empty()) {
+      double r = random_unit() * this->free_cdf.back();
+      size_t cell = upper_bound(this->free_cdf.begin(), this->free_cdf.end(), r)
+                    - this->free_cdf.begin();
+      cell = min(cell, this->free_cdf.size() - 1);
+      const Point &A = this->free_cells[3 * cell];
+      const Point &B = this->free_cells[3 * cell + 1];
+      const Point &C = this->free_cells[3 * cell + 2];
+
+      double u = random_unit();
+      double v = random_unit();
+      if (u + v > 1) { u = 1 - u; v = 1 - v; } /* Reflect into the triangle */
+      p = A + (B - A).scale(u) + (C - A).scale(v);
+    } else {
+      p = sample_uniform(this->width, this->height);
+    }
+
+    this->num_samples += 1;
+    /* Only points on a cell boundary touching an obstacle are rejected */
+    if (is_freespace(p)) { return p; }
+    this->num_rejections += 1;
+  }
+}
+
+/**
+ * @brief Samples a normally distributed number with the Box-Muller transform.
+ *
+ * @param sigma Standard deviation.
+ * @return A number drawn from N(0, sigma^2).
+ */
+double sample_normal(double sigma) {
+  double u = random_unit_open();
+  double v = random_unit();
+  return sigma * sqrt(-2 * log(u)) * cos(2 * M_PI * v);
+}
+
+/**
+ * @brief Gaussian sampler. Draws a uniform point and a second one normally
+ * distributed around it, and keeps whichever is free if the other is not.
+ * Samples pile up along obstacle boundaries, where passages are.
+ *
+ * @return A point inside the dimensions of the map and free of obstacles.
+ */
+Point Map::sample_gaussian() {
+  for (int i = 0; i < BIASED_MAX_TRIES; i++) {
+    Point a = sample_uniform(this->width, this->height);
+    Point b = a + Point(sample_normal(this->sample_sigma), sample_normal(this->sample_sigma));
+    bool a_free = is_freespace(a);
+    bool b_free = in_bounds(b) && is_freespace(b);
+    if (a_free != b_free) { return a_free ? a : b; }
+  }
+  return sample_freespace();
+}
+
+/**
+ * @brief Bridge test sampler. Draws two nearby points that both collide and
+ * keeps their midpoint if it is free, which mostly happens in gaps between
+ * obstacles that are narrow compared to sample_sigma. The map's edges count
+ * as obstacles, so doorways in walls that end at the edge are found too.
+ *
+ * @return A point inside the dimensions of the map and free of obstacles.
+ */
+Point Map::sample_bridge() {
+  for (int i = 0; i < BIASED_MAX_TRIES; i++) {
+    Point a = sample_uniform(this->width, this->height);
+    if (is_freespace(a)) { continue; }
+    Point b = a + Point(sample_normal(this->sample_sigma), sample_normal(this->sample_sigma));
+    if (in_bounds(b) && is_freespace(b)) { continue; }
+    Point mid = (a + b).scale(0.5);
+    if (in_bounds(mid) && is_freespace(mid)) { return mid; }
+  }
+  return sample_freespace();
+}
+
+/**
+ * @brief Samples a configuration for the planners, mixing the bridge test,
+ * Gaussian and uniform samplers in the proportions set by bridge_ratio and
+ * gaussian_ratio.
+ *
+ * @return A point inside the dimensions of the map and free of obstacles.
+ */
+Point Map::sample() {
+  double r = random_unit();
+  if (r < this->bridge_ratio) { return sample_bridge(); }
+  if (r < this->bridge_ratio + this->gaussian_ratio) { return sample_gaussian(); }
+  return sample_freespace();
+}
+
+/**
+ * @brief Fraction of samples drawn so far that were rejected for landing in
+ * an obstacle.
+ *
+ * @return Rejection rate between 0 and 1.
+ */
+double Map::rejection_rate() const {
+  if (this->num_samples == 0) { return 0; }
+  return (double) this->num_rejections / this->num_samples;
 }
\ No newline at end of file
@@ -17,6 +17,14 @@
 #include "Point.h"
 #include "Obstacle.h"
 
+/* Obstacle-biased samplers give up and sample uniformly after this many
+ * failed draws, e.g. on maps without obstacles */
+#define BIASED_MAX_TRIES 1000
+
+/* Decompositions with more cells are dropped for rejection sampling. Cells
+ * grow faster than obstacles on cluttered maps, 4M cells take ~230MB. */
+#define DECOMPOSE_MAX_CELLS (1 << 22)
+
 class Map {
   public:
     /* Data */
@@ -27,6 +35,26 @@ class Map {
     vector<Obstacle> obstacles;
     vector<Obstacle> minkowski;
 
+    /* Free space decomposed into triangles (3 points per cell) */
+    vector<Point> free_cells;
+    vector<double> free_cdf; /* Cumulative cell areas */
+    bool decomposed;
+    bool use_decomposition; /* False falls back to rejection sampling */
+
+    /* Mix drawn by sample(), the rest is uniform over the free space */
+    float gaussian_ratio; /* Fraction from sample_gaussian */
+    float bridge_ratio;   /* Fraction from sample_bridge */
+    float sample_sigma;   /* Spread of the second point in both, about the
+                           * width of the passages to find */
+
+    /* Sampling statistics */
+    long num_samples;
+    long num_rejections;
+
+    /* Collision checking statistics */
+    mutable long num_point_checks; /* Calls to is_freespace */
+    mutable long num_path_checks;  /* Calls to is_valid_path */
+
     /* Constructors */
     Map(const float &robot_radius);
     Map(const float &robot_radius, const vector<Obstacle> &obs);
@@ -34,8 +62,17 @@ class Map {
 
     /* Function Prototypes */
     void add_obstacle(const Obstacle &o);
+    void remove_obstacle(int index);
     bool is_freespace(const Point &p) const;
     bool is_valid_path(const Point &p1, const Point &p2) const;
+    bool in_bounds(const Point &p) const;
+
+    void decompose_freespace();
+    Point sample_freespace();
+    Point sample_gaussian();
+    Point sample_bridge();
+    Point sample();
+    double rejection_rate() const;
 };
 
 #endif /* __MAP_H */
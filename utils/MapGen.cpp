@@ -0,0 +1,458 @@
+/**
+ *  @file MapGen.cpp
+ *  @brief Implements the map generators defined in MapGen.h
+ *
+ *  @author Shashank Ojha (shashano)
+ *  @author Serris Lew (snlew)
+ *  @author David Bick (dbick)
+ *  @bug No known bugs.
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+#include "MapGen.h"
+#include "Obstacle.h"
+
+using namespace std;
+
+/****************************************************************************/
+
+                                /* Shapes */
+
+/****************************************************************************/
+
+/**
+ * @brief Area of a polygon by the shoelace formula.
+ *
+ * @param polygon Vertices in counter-clockwise order.
+ * @return Area.
+ */
+static double polygon_area(const vector<Point> &polygon) {
+  double twice = 0;
+  int n = polygon.size();
+  for (int i = 0; i < n; i++) {
+    twice += polygon[i].cross(polygon[(i+1) % n]);
+  }
+  return twice / 2;
+}
+
+/**
+ * @brief Random convex polygon around the origin. Its vertices lie on a
+ * circle, one in each of equal arcs, which keeps them apart enough to stay
+ * convex once written out.
+ *
+ * @param gen Random number generator.
+ * @param radius Radius of the circle.
+ * @return Vertices in counter-clockwise order.
+ */
+static vector<Point> random_convex(mt19937 &gen, double radius) {
+  uniform_real_distribution<double> unit(0, 1);
+  int n = GEN_MIN_VERTICES + gen() % (GEN_MAX_VERTICES - GEN_MIN_VERTICES + 1);
+  double arc = 2 * M_PI / n;
+  double offset = arc * unit(gen);
+  vector<Point> polygon;
+  for (int k = 0; k < n; k++) {
+    double a = offset + arc * (k + 0.7 * unit(gen));
+    polygon.push_back(Point(radius * cos(a), radius * sin(a)));
+  }
+  return polygon;
+}
+
+/**
+ * @brief Axis aligned rectangle.
+ *
+ * @return Corners in counter-clockwise order.
+ */
+static vector<Point> rectangle(double x0, double y0, double x1, double y1) {
+  return {Point(x0, y0), Point(x1, y0), Point(x1, y1), Point(x0, y1)};
+}
+
+/****************************************************************************/
+
+                             /* Generated Map */
+
+/****************************************************************************/
+
+/**
+ * @brief Fraction of the map covered by obstacles, counting overlaps twice.
+ *
+ * @return Obstacle area over map area.
+ */
+double Generated_Map::density() const {
+  double area = 0;
+  for (const vector<Point> &polygon : this->obstacles) { area += polygon_area(polygon); }
+  return area / (4 * this->width * this->height);
+}
+
+/**
+ * @brief Writes the map in the text format read by Map: height and width,
+ * the number of obstacles and then each obstacle as its number of vertices
+ * followed by one vertex per line.
+ *
+ * @param filename The file to write.
+ * @return Void.
+ */
+void Generated_Map::write(const string &filename) const {
+  ofstream out(filename);
+  if (!out) {
+    throw invalid_argument("Generated_Map::write: Unable to open file!");
+  }
+  out << setprecision(9);
+  out << this->height << " " << this->width << "\n";
+  out << this->obstacles.size() << "\n";
+  for (const vector<Point> &polygon : this->obstacles) {
+    out << polygon.size() << "\n";
+    for (const Point &p : polygon) { out << p.x << " " << p.y << "\n"; }
+  }
+}
+
+/**
+ * @brief Writes the queries in the format read by plan-batch, one
+ * "xs ys xt yt" per line.
+ *
+ * @param filename The file to write.
+ * @return Void.
+ */
+void Generated_Map::write_queries(const string &filename) const {
+  ofstream out(filename);
+  if (!out) {
+    throw invalid_argument("Generated_Map::write_queries: Unable to open file!");
+  }
+  out << setprecision(9);
+  out << "# xs ys xt yt" << "\n";
+  for (const pair<Point, Point> &q : this->queries) {
+    out << q.first.x << " " << q.first.y << " " << q.second.x << " " << q.second.y << "\n";
+  }
+}
+
+/****************************************************************************/
+
+                               /* Cell Maps */
+
+/****************************************************************************/
+
+/* Square grid of cells holding at most one obstacle each */
+struct Cell_Grid {
+  int side;              /* Cells along each axis */
+  double half;           /* Half the width of the map */
+  vector<int> obstacle;  /* Index in the map of the obstacle in each cell, or -1 */
+
+  Cell_Grid(int side) : side(side), half(side * GEN_CELL / 2.0),
+                        obstacle(side * side, -1) {}
+
+  Point center(int cell) const {
+    return Point(-half + (cell % side + 0.5) * GEN_CELL,
+                 -half + (cell / side + 0.5) * GEN_CELL);
+  }
+};
+
+/**
+ * @brief Moves a shape into a cell of the grid and adds it to the map.
+ *
+ * @return Void.
+ */
+static void place(Generated_Map &map, Cell_Grid &grid, int cell,
+                  const vector<Point> &shape) {
+  Point c = grid.center(cell);
+  vector<Point> polygon;
+  for (const Point &p : shape) { polygon.push_back(p + c); }
+  grid.obstacle[cell] = map.obstacles.size();
+  map.obstacles.push_back(polygon);
+}
+
+/**
+ * @brief Checks whether the robot fits at p. Only the obstacle of p's own
+ * cell can reach it, since obstacles keep clear of their cell's border.
+ *
+ * @return True if p is in free space.
+ */
+static bool is_free(const Generated_Map &map, const Cell_Grid &grid, const Point &p) {
+  int i = min(grid.side - 1, (int) ((p.x + grid.half) / GEN_CELL));
+  int j = min(grid.side - 1, (int) ((p.y + grid.half) / GEN_CELL));
+  int index = grid.obstacle[j * grid.side + i];
+  if (index < 0) { return true; }
+  Obstacle o(map.obstacles[index]);
+  return !Obstacle::minkowski_sum(o, GEN_ROBOT_RADIUS).collides(p);
+}
+
+/**
+ * @brief Adds queries between random free points at least half the map's
+ * width apart. Any two free points of a cell map are connected.
+ *
+ * @return Void.
+ */
+static void add_cell_queries(Generated_Map &map, const Cell_Grid &grid, int num_queries,
+                             mt19937 &gen) {
+  double margin = GEN_ROBOT_RADIUS;
+  uniform_real_distribution<double> coord(-grid.half + margin, grid.half - margin);
+  while ((int) map.queries.size() < num_queries) {
+    Point s(coord(gen), coord(gen));
+    Point t(coord(gen), coord(gen));
+    if (s.dist(t) < grid.half || !is_free(map, grid, s) || !is_free(map, grid, t)) {
+      continue;
+    }
+    map.queries.push_back({s, t});
+  }
+}
+
+/**
+ * @brief Random convex obstacles, one to a cell, over a square map sized so
+ * that they cover about the given fraction of it. The densest map fills
+ * every cell, which covers about 17% of the map.
+ *
+ * @param num_obstacles Number of obstacles.
+ * @param density Fraction of the map to cover.
+ * @param num_queries Start/goal pairs to add.
+ * @param seed Seed of the generator.
+ * @return Generated map.
+ */
+Generated_Map generate_clutter(int num_obstacles, double density, int num_queries,
+                               unsigned seed) {
+  if (num_obstacles < 1 || density <= 0 || density >= 1) {
+    throw invalid_argument("generate_clutter: Needs obstacles and a density in (0, 1)!");
+  }
+  mt19937 gen(seed);
+  uniform_real_distribution<double> unit(0, 1);
+  double max_radius = GEN_CELL / 2.0 - GEN_CLEARANCE;
+
+  vector<vector<Point>> shapes;
+  double area = 0;
+  for (int i = 0; i < num_obstacles; i++) {
+    shapes.push_back(random_convex(gen, max_radius * (0.5 + 0.5 * unit(gen))));
+    area += polygon_area(shapes.back());
+  }
+  int side = max(ceil(sqrt(num_obstacles)), ceil(sqrt(area / density) / GEN_CELL));
+
+  Cell_Grid grid(side);
+  vector<int> cells(side * side);
+  for (size_t i = 0; i < cells.size(); i++) { cells[i] = i; }
+  shuffle(cells.begin(), cells.end(), gen);
+
+  Generated_Map map;
+  map.height = grid.half;
+  map.width = grid.half;
+  for (int i = 0; i < num_obstacles; i++) { place(map, grid, cells[i], shapes[i]); }
+  add_cell_queries(map, grid, num_queries, gen);
+  return map;
+}
+
+/**
+ * @brief Clusters of densely packed obstacles in a map that is mostly empty,
+ * with about OPEN_CLUSTER obstacles in each cluster.
+ *
+ * @param num_obstacles Number of obstacles.
+ * @param num_queries Start/goal pairs to add.
+ * @param seed Seed of the generator.
+ * @return Generated map.
+ */
+Generated_Map generate_open(int num_obstacles, int num_queries, unsigned seed) {
+  if (num_obstacles < 1) {
+    throw invalid_argument("generate_open: Needs at least one obstacle!");
+  }
+  mt19937 gen(seed);
+  uniform_real_distribution<double> unit(0, 1);
+  normal_distribution<double> spread(0, sqrt(OPEN_CLUSTER / M_PI));
+  double max_radius = GEN_CELL / 2.0 - GEN_CLEARANCE;
+
+  int side = ceil(sqrt(num_obstacles / OPEN_FILL));
+  Cell_Grid grid(side);
+  int num_clusters = max(1, num_obstacles / OPEN_CLUSTER);
+  vector<pair<double, double>> clusters;
+  for (int k = 0; k < num_clusters; k++) {
+    clusters.push_back({side * unit(gen), side * unit(gen)});
+  }
+
+  Generated_Map map;
+  map.height = grid.half;
+  map.width = grid.half;
+  while ((int) map.obstacles.size() < num_obstacles) {
+    pair<double, double> c = clusters[gen() % num_clusters];
+    int i = (int) floor(c.first + spread(gen));
+    int j = (int) floor(c.second + spread(gen));
+    if (i < 0 || j < 0 || i >= side || j >= side) { continue; }
+    if (grid.obstacle[j * side + i] >= 0) { continue; }
+    place(map, grid, j * side + i, random_convex(gen, max_radius * (0.5 + 0.5 * unit(gen))));
+  }
+  add_cell_queries(map, grid, num_queries, gen);
+  return map;
+}
+
+/****************************************************************************/
+
+                                  /* Mazes */
+
+/****************************************************************************/
+
+/**
+ * @brief Maze carved by a randomized depth first search, so there is exactly
+ * one way between any two cells. Every wall left standing is an obstacle,
+ * plus one along each side of the map. The maze is the smallest square with
+ * at least num_obstacles walls.
+ *
+ * @param num_obstacles Number of walls to aim for.
+ * @param num_queries Start/goal pairs to add, the first between opposite
+ * corners.
+ * @param seed Seed of the generator.
+ * @return Generated map.
+ */
+Generated_Map generate_maze(int num_obstacles, int num_queries, unsigned seed) {
+  if (num_obstacles < 1) {
+    throw invalid_argument("generate_maze: Needs at least one obstacle!");
+  }
+  mt19937 gen(seed);
+  /* A perfect maze of k x k cells keeps (k - 1)^2 inner walls */
+  int k = max(2, 1 + (int) ceil(sqrt(max(num_obstacles - 4, 1))));
+  double half = k * MAZE_CELL / 2.0;
+
+  /* east[c] is the wall on the right of cell c, north[c] the one above */
+  vector<bool> east(k * k, true), north(k * k, true), visited(k * k, false);
+  vector<int> stack = {0};
+  visited[0] = true;
+  while (!stack.empty()) {
+    int c = stack.back();
+    int x = c % k, y = c / k;
+    int options[4], n = 0;
+    if (x + 1 < k && !visited[c + 1]) { options[n++] = c + 1; }
+    if (x > 0 && !visited[c - 1]) { options[n++] = c - 1; }
+    if (y + 1 < k && !visited[c + k]) { options[n++] = c + k; }
+    if (y > 0 && !visited[c - k]) { options[n++] = c - k; }
+    if (n == 0) {
+      stack.pop_back();
+      continue;
+    }
+    int next = options[gen() % n];
+    if (next == c + 1) { east[c] = false; }
+    if (next == c - 1) { east[next] = false; }
+    if (next == c + k) { north[c] = false; }
+    if (next == c - k) { north[next] = false; }
+    visited[next] = true;
+    stack.push_back(next);
+  }
+
+  Generated_Map map;
+  map.height = half;
+  map.width = half;
+  double t = MAZE_WALL / 2;
+  for (int c = 0; c < k * k; c++) {
+    double x0 = -half + (c % k) * MAZE_CELL;
+    double y0 = -half + (c / k) * MAZE_CELL;
+    if (c % k + 1 < k && east[c]) {
+      double x = x0 + MAZE_CELL;
+      map.obstacles.push_back(rectangle(x - t, y0 - t, x + t, y0 + MAZE_CELL + t));
+    }
+    if (c / k + 1 < k && north[c]) {
+      double y = y0 + MAZE_CELL;
+      map.obstacles.push_back(rectangle(x0 - t, y - t, x0 + MAZE_CELL + t, y + t));
+    }
+  }
+  map.obstacles.push_back(rectangle(-half, -half, half, -half + t));
+  map.obstacles.push_back(rectangle(-half, half - t, half, half));
+  map.obstacles.push_back(rectangle(-half, -half, -half + t, half));
+  map.obstacles.push_back(rectangle(half - t, -half, half, half));
+
+  /* Cell centers are free and every cell reaches every other */
+  uniform_int_distribution<int> cell(0, k * k - 1);
+  auto center = [&](int c) {
+    return Point(-half + (c % k + 0.5) * MAZE_CELL, -half + (c / k + 0.5) * MAZE_CELL);
+  };
+  while ((int) map.queries.size() < num_queries) {
+    int s = map.queries.empty() ? 0 : cell(gen);
+    int g = map.queries.empty() ? k * k - 1 : cell(gen);
+    if (s != g) { map.queries.push_back({center(s), center(g)}); }
+  }
+  return map;
+}
+
+/****************************************************************************/
+
+                                /* Corridors */
+
+/****************************************************************************/
+
+/**
+ * @brief Row of walls across a map CORRIDOR_HEIGHT high, each with one door
+ * at a random height. Every wall is two obstacles, one on each side of its
+ * door, so a path from the first bay to the last has to thread every door.
+ *
+ * @param num_obstacles Number of obstacles, two per wall.
+ * @param gap Width of the doors. The robot's center has gap minus its
+ * diameter to pass through.
+ * @param num_queries Start/goal pairs to add, the first from the first bay
+ * to the last.
+ * @param seed Seed of the generator.
+ * @return Generated map.
+ */
+Generated_Map generate_corridors(int num_obstacles, double gap, int num_queries,
+                                 unsigned seed) {
+  if (num_obstacles < 1 || gap <= 0 || gap > CORRIDOR_HEIGHT - 2 * CORRIDOR_WALL) {
+    throw invalid_argument("generate_corridors: Needs obstacles and a door that fits!");
+  }
+  mt19937 gen(seed);
+  int num_walls = max(1, num_obstacles / 2);
+  double half_w = CORRIDOR_SPACING * (num_walls + 1) / 2.0;
+  double half_h = CORRIDOR_HEIGHT / 2.0;
+  uniform_real_distribution<double> door(-half_h + CORRIDOR_WALL + gap / 2,
+                                         half_h - CORRIDOR_WALL - gap / 2);
+
+  Generated_Map map;
+  map.height = half_h;
+  map.width = half_w;
+  double t = CORRIDOR_WALL / 2;
+  for (int w = 0; w < num_walls; w++) {
+    double x = -half_w + (w + 1) * CORRIDOR_SPACING;
+    double y = door(gen);
+    map.obstacles.push_back(rectangle(x - t, -half_h, x + t, y - gap / 2));
+    map.obstacles.push_back(rectangle(x - t, y + gap / 2, x + t, half_h));
+  }
+
+  /* Bays are the free columns between walls, their centers clear of both */
+  uniform_int_distribution<int> bay(0, num_walls);
+  uniform_real_distribution<double> height(-half_h + GEN_ROBOT_RADIUS,
+                                           half_h - GEN_ROBOT_RADIUS);
+  auto point_in = [&](int b, double y) {
+    return Point(-half_w + (b + 0.5) * CORRIDOR_SPACING, y);
+  };
+  while ((int) map.queries.size() < num_queries) {
+    if (map.queries.empty()) {
+      map.queries.push_back({point_in(0, 0), point_in(num_walls, 0)});
+      continue;
+    }
+    int s = bay(gen), g = bay(gen);
+    if (s != g) { map.queries.push_back({point_in(s, height(gen)), point_in(g, height(gen))}); }
+  }
+  return map;
+}
+
+/**
+ * @brief Generates a map of any kind.
+ *
+ * @param kind One of MAP_CLUTTER, MAP_MAZE, MAP_CORRIDORS or MAP_OPEN.
+ * @param num_obstacles Number of obstacles.
+ * @param param Density of clutter or door width of corridors, 0 for the
+ * default. Other kinds ignore it.
+ * @param num_queries Start/goal pairs to add.
+ * @param seed Seed of the generator.
+ * @return Generated map.
+ */
+Generated_Map generate_map(int kind, int num_obstacles, double param, int num_queries,
+                           unsigned seed) {
+  switch (kind) {
+    case MAP_CLUTTER:
+      return generate_clutter(num_obstacles, (param > 0) ? param : DEFAULT_DENSITY,
+                              num_queries, seed);
+    case MAP_MAZE:
+      return generate_maze(num_obstacles, num_queries, seed);
+    case MAP_CORRIDORS:
+      return generate_corridors(num_obstacles, (param > 0) ? param : DEFAULT_GAP,
+                                num_queries, seed);
+    case MAP_OPEN:
+      return generate_open(num_obstacles, num_queries, seed);
+  }
+  throw invalid_argument("generate_map: Unknown kind of map!");
+}
@@ -0,0 +1,80 @@
+/**
+ *  @file MapGen.h
+ *  @brief Defines procedural generation of maps in the text format read by
+ *  Map, together with start/goal queries that are valid on them. Every
+ *  generator is deterministic in its seed.
+ *
+ *  @author Shashank Ojha (shashano)
+ *  @author Serris Lew (snlew)
+ *  @author David Bick (dbick)
+ *  @bug No known bugs.
+ */
+
+#ifndef __MAPGEN_H
+#define __MAPGEN_H
+
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "Point.h"
+
+/* Kinds of generated maps */
+#define MAP_CLUTTER 0   /* Convex obstacles scattered over a grid of cells */
+#define MAP_MAZE 1      /* Walls of a maze with one path between any cells */
+#define MAP_CORRIDORS 2 /* Row of walls, each with one narrow door */
+#define MAP_OPEN 3      /* Few clusters of obstacles in a large empty map */
+
+/* Clutter and open maps put at most one obstacle in each cell and keep it
+ * GEN_CLEARANCE away from the cell's border, so the lines between cells are
+ * free for the robot and every free point is connected to every other */
+#define GEN_ROBOT_RADIUS 1
+#define GEN_CLEARANCE 1.2
+#define GEN_CELL 6
+#define GEN_MIN_VERTICES 3
+#define GEN_MAX_VERTICES 8
+
+/* Fraction of the cells an open map fills, and obstacles per cluster */
+#define OPEN_FILL 0.05
+#define OPEN_CLUSTER 100
+
+/* Maze cells are corridors MAZE_CELL - MAZE_WALL wide */
+#define MAZE_CELL 4
+#define MAZE_WALL 0.5
+
+/* Corridor walls are CORRIDOR_SPACING apart across a map CORRIDOR_HEIGHT
+ * high, with doors DEFAULT_GAP wide unless asked otherwise */
+#define CORRIDOR_SPACING 6
+#define CORRIDOR_HEIGHT 20
+#define CORRIDOR_WALL 0.5
+#define DEFAULT_GAP 2.4
+
+#define DEFAULT_DENSITY 0.1
+
+/* Obstacles of a generated map and queries between free points on it. The
+ * map covers [-width, width] x [-height, height] like Map. */
+class Generated_Map {
+  public:
+    /* Data */
+    double height;
+    double width;
+    vector<vector<Point>> obstacles; /* Convex, counter-clockwise */
+    vector<pair<Point, Point>> queries;
+
+    /* Function Prototypes */
+    double density() const;
+    void write(const string &filename) const;
+    void write_queries(const string &filename) const;
+};
+
+/* Generators */
+Generated_Map generate_clutter(int num_obstacles, double density, int num_queries,
+                               unsigned seed);
+Generated_Map generate_maze(int num_obstacles, int num_queries, unsigned seed);
+Generated_Map generate_corridors(int num_obstacles, double gap, int num_queries,
+                                 unsigned seed);
+Generated_Map generate_open(int num_obstacles, int num_queries, unsigned seed);
+Generated_Map generate_map(int kind, int num_obstacles, double param, int num_queries,
+                           unsigned seed);
+
+#endif /* __MAPGEN_H */
@@ -0,0 +1,206 @@
+/**
+ *  @file Memory.h
+ *  @brief Defines per-thread accounting of the memory held by planner trees.
+ *  Containers count through Counting_Allocator and classes that live on the
+ *  heap one at a time count through counted_new and counted_delete. Bytes
+ *  are counted as requested, without the overhead of malloc itself.
+ *
+ *  NOTE: The implementation is also found in this file instead of a separate
+ *  cpp file. This is necessary for templates. For more information see:
+ *    https://isocpp.org/wiki/faq/templates#templates-defn-vs-decl
+ *
+ *  @author Shashank Ojha (shashano)
+ *  @author Serris Lew (snlew)
+ *  @author David Bick (dbick)
+ *  @bug Memory freed on another thread than it was allocated on is taken off
+ *  the freeing thread's count.
+ */
+
+#ifndef __MEMORY_H
+#define __MEMORY_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <new>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+using namespace std;
+
+/* Running totals of one thread */
+struct Mem_Stats {
+  int64_t bytes;       /* Held right now */
+  int64_t peak_bytes;  /* Most ever held at once */
+  int64_t allocations; /* Calls that allocated, ever */
+};
+
+/* Memory used while a plan was made */
+struct Mem_Usage {
+  int64_t peak_bytes;  /* Most held at once, above what was held at the start */
+  int64_t live_bytes;  /* Still held at the end, the tree handed back */
+  int64_t allocations;
+};
+
+inline thread_local Mem_Stats thread_memory = {0, 0, 0};
+
+/**
+ * @brief Counts an allocation on the calling thread.
+ *
+ * @param size Bytes allocated.
+ * @return Void.
+ */
+inline void count_alloc(size_t size) {
+  Mem_Stats &m = thread_memory;
+  m.bytes += size;
+  m.allocations += 1;
+  if (m.bytes > m.peak_bytes) { m.peak_bytes = m.bytes; }
+}
+
+/**
+ * @brief Counts a deallocation on the calling thread.
+ *
+ * @param size Bytes freed.
+ * @return Void.
+ */
+inline void count_free(size_t size) {
+  thread_memory.bytes -= size;
+}
+
+/**
+ * @brief Counted replacement for operator new, for class specific overloads.
+ *
+ * @param size Bytes to allocate.
+ * @return Memory of the given size.
+ */
+inline void *counted_new(size_t size) {
+  count_alloc(size);
+  return ::operator new(size);
+}
+
+/**
+ * @brief Counted replacement for sized operator delete.
+ *
+ * @param p Memory from counted_new.
+ * @param size Bytes it was allocated with.
+ * @return Void.
+ */
+inline void counted_delete(void *p, size_t size) {
+  count_free(size);
+  ::operator delete(p);
+}
+
+/* Standard allocator that counts what it hands out. Stateless, so all of
+ * them compare equal and containers may free each other's memory. */
+template <typename T>
+class Counting_Allocator {
+  public:
+    typedef T value_type;
+
+    /* Constructors */
+    Counting_Allocator() {}
+    template <typename U> Counting_Allocator(const Counting_Allocator<U> &) {}
+
+    /* Function Prototypes */
+    T *allocate(size_t n);
+    void deallocate(T *p, size_t n);
+
+    template <typename U> bool operator == (const Counting_Allocator<U> &) const {
+      return true;
+    }
+    template <typename U> bool operator != (const Counting_Allocator<U> &) const {
+      return false;
+    }
+};
+
+/* Containers whose memory is counted */
+template <typename T>
+using counted_vector = vector<T, Counting_Allocator<T>>;
+template <typename K>
+using counted_set = unordered_set<K, hash<K>, equal_to<K>, Counting_Allocator<K>>;
+template <typename K, typename V>
+using counted_map = unordered_map<K, V, hash<K>, equal_to<K>,
+                                  Counting_Allocator<pair<const K, V>>>;
+
+/* Measures the memory counted on the calling thread between its construction
+ * and a call to usage. Scopes may nest. */
+class Memory_Scope {
+  public:
+    /* Constructors */
+    Memory_Scope();
+    Memory_Scope(const Memory_Scope &other) = delete;
+    ~Memory_Scope();
+
+    /* Function Prototypes */
+    Mem_Usage usage() const;
+
+  private:
+    /* Data */
+    Mem_Stats base;
+};
+
+/****************************************************************************/
+
+                            /* Implementation */
+
+/****************************************************************************/
+
+/**
+ * @brief Allocates and counts room for n objects.
+ *
+ * @param n Number of objects.
+ * @return Uninitialized memory.
+ */
+template <typename T>
+T *Counting_Allocator<T>::allocate(size_t n) {
+  count_alloc(n * sizeof(T));
+  return static_cast<T*>(::operator new(n * sizeof(T)));
+}
+
+/**
+ * @brief Frees and uncounts room for n objects.
+ *
+ * @param p Memory from allocate.
+ * @param n Number of objects it was allocated for.
+ * @return Void.
+ */
+template <typename T>
+void Counting_Allocator<T>::deallocate(T *p, size_t n) {
+  count_free(n * sizeof(T));
+  ::operator delete(p);
+}
+
+/**
+ * @brief Constructor that starts measuring. The thread's peak restarts at
+ * what it holds now, so the scope sees only its own peak.
+ *
+ * @return Scope.
+ */
+inline Memory_Scope::Memory_Scope() {
+  this->base = thread_memory;
+  thread_memory.peak_bytes = thread_memory.bytes;
+}
+
+/**
+ * @brief Destructor. Puts back the peak of an enclosing scope.
+ */
+inline Memory_Scope::~Memory_Scope() {
+  thread_memory.peak_bytes = max(thread_memory.peak_bytes, this->base.peak_bytes);
+}
+
+/**
+ * @brief Memory counted since the scope started.
+ *
+ * @return Peak and live bytes above the start and the number of allocations.
+ */
+inline Mem_Usage Memory_Scope::usage() const {
+  Mem_Usage u;
+  u.peak_bytes = thread_memory.peak_bytes - this->base.bytes;
+  u.live_bytes = thread_memory.bytes - this->base.bytes;
+  u.allocations = thread_memory.allocations - this->base.allocations;
+  return u;
+}
+
+#endif /* __MEMORY_H */
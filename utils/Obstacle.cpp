@@ -8,6 +8,9 @@
  *  @bug No known bugs.
  */
 
+#include <algorithm>
+#include <cassert>
+#include <cmath>
 #include <unordered_map>
 #include <unordered_set>
 #include <vector>
@@ -15,21 +18,95 @@
 #include "Obstacle.h"
 #include "Point.h"
 
+/****************************************************************************/
+
+                             /* Exact Predicates */
+
+/****************************************************************************/
+
 /**
- * @brief Obstacle constructor given vector of points.
+ * @brief Computes a + b and the roundoff error of the sum, so that x + y
+ * equals a + b exactly.
  *
- * @param polygon vector of points defining convex polygon.
- * @return Obstacle containing given points.
+ * @return Void.
  */
-Obstacle::Obstacle(const vector<Point> &polygon) {
-  assert(is_convex_hull(polygon));
-  convex_hull = vector<Point>(polygon);
+static inline void two_sum(double a, double b, double &x, double &y) {
+  x = a + b;
+  double b_virtual = x - a;
+  double a_virtual = x - b_virtual;
+  y = (a - a_virtual) + (b - b_virtual);
 }
 
+/**
+ * @brief Computes a - b and the roundoff error of the difference, so that
+ * x + y equals a - b exactly.
+ *
+ * @return Void.
+ */
+static inline void two_diff(double a, double b, double &x, double &y) {
+  two_sum(a, -b, x, y);
+}
+
+/**
+ * @brief Computes a * b and the roundoff error of the product, so that
+ * x + y equals a * b exactly.
+ *
+ * @return Void.
+ */
+static inline void two_product(double a, double b, double &x, double &y) {
+  x = a * b;
+  y = fma(a, b, -x);
+}
+
+/**
+ * @brief Exact sign of (A - test) x (B - test). Each difference is split
+ * into a double and its roundoff, the products of the parts into doubles and
+ * their roundoff, and the sixteen terms are summed into a nonoverlapping
+ * expansion, whose largest nonzero component has the sign of the whole sum.
+ * Only reached when the floating point test cannot tell.
+ *
+ * @return Line side test result of test with respect to line AB.
+ */
+static int exact_line_side_test(const Point &test, const Point &A, const Point &B) {
+  double a[2], b[2], c[2], d[2]; /* (a)(b) - (c)(d) */
+  two_diff(A.x, test.x, a[1], a[0]);
+  two_diff(B.y, test.y, b[1], b[0]);
+  two_diff(A.y, test.y, c[1], c[0]);
+  two_diff(B.x, test.x, d[1], d[0]);
+
+  double terms[16];
+  int n = 0;
+  for (int i = 0; i < 2; i++) {
+    for (int j = 0; j < 2; j++) {
+      two_product(a[i], b[j], terms[n + 1], terms[n]);
+      two_product(-c[i], d[j], terms[n + 3], terms[n + 2]);
+      n += 4;
+    }
+  }
+
+  /* Grow the expansion one term at a time, smallest component first */
+  double expansion[16];
+  int size = 0;
+  for (int t = 0; t < 16; t++) {
+    double q = terms[t];
+    for (int k = 0; k < size; k++) {
+      two_sum(q, expansion[k], q, expansion[k]);
+    }
+    expansion[size++] = q;
+  }
+  for (int k = size - 1; k >= 0; k--) {
+    if (expansion[k] > 0) { return LEFT; }
+    if (expansion[k] < 0) { return RIGHT; }
+  }
+  return ON;
+}
 
 /**
  * @brief Returns whether the test point is ON, the LEFT of, or the RIGHT of
- * the line passing through A and B.
+ * the line passing through A and B. The cross product is computed in
+ * floating point and its sign used whenever it exceeds the bound on its
+ * rounding error, which is nearly always. Otherwise the sign is computed
+ * exactly, so nearly collinear points are never misclassified.
  *
  * @param test Point to test.
  * @param A First point on line.
@@ -37,16 +114,85 @@ Obstacle::Obstacle(const vector<Point> &polygon) {
  * @return Line side test result of current point with respect to line AB.
  */
 int line_side_test(const Point &test, const Point &A, const Point &B) {
-  Point line = B - A;
-  Point error = test - A;
-  double cross_prod = line.cross(error);
-  if (cross_prod > 0) {
+  double left = (A.x - test.x) * (B.y - test.y);
+  double right = (A.y - test.y) * (B.x - test.x);
+  double det = left - right;
+  double errbound = LINE_SIDE_ERRBOUND * (fabs(left) + fabs(right));
+  if (det > errbound) {
     return LEFT;
   }
-  else if (cross_prod < 0) {
+  else if (-det > errbound) {
     return RIGHT;
   }
-  return ON;
+  return exact_line_side_test(test, A, B);
+}
+
+/****************************************************************************/
+
+                                /* Obstacle */
+
+/****************************************************************************/
+
+/**
+ * @brief Obstacle constructor given vector of points.
+ *
+ * @param polygon vector of points defining convex polygon.
+ * @return Obstacle containing given points.
+ */
+Obstacle::Obstacle(const vector<Point> &polygon) {
+  assert(is_convex_hull(polygon));
+  convex_hull = vector<Point>(polygon);
+  int n = this->convex_hull.size();
+
+  this->lo = this->convex_hull[0];
+  this->hi = this->convex_hull[0];
+  for (const Point &p : this->convex_hull) {
+    this->lo = Point(min(this->lo.x, p.x), min(this->lo.y, p.y));
+    this->hi = Point(max(this->hi.x, p.x), max(this->hi.y, p.y));
+  }
+
+  /* The first turn that is not straight gives the winding, and the inside
+   * is on the side the hull turns to */
+  this->outside = ON;
+  for (int i = 0; i < n && this->outside == ON; i++) {
+    this->outside = -line_side_test(this->convex_hull[(i+2) % n], this->convex_hull[i],
+                                    this->convex_hull[(i+1) % n]);
+  }
+  /* A hull with no area runs both ways along its line, so either side works,
+   * and the sides of its box keep the half-planes bounded */
+  if (this->outside == ON) {
+    this->outside = RIGHT;
+    add_half_plane(Point(1, 0), this->hi.x);
+    add_half_plane(Point(-1, 0), -this->lo.x);
+    add_half_plane(Point(0, 1), this->hi.y);
+    add_half_plane(Point(0, -1), -this->lo.y);
+  }
+  this->extent = max(max(fabs(this->lo.x), fabs(this->lo.y)),
+                     max(fabs(this->hi.x), fabs(this->hi.y)));
+
+  for (int i = 0; i < n; i++) {
+    const Point &A = this->convex_hull[i];
+    const Point &B = this->convex_hull[(i+1) % n];
+    Point edge = B - A;
+    if (edge.x == 0 && edge.y == 0) { continue; } /* Repeated vertex */
+    /* The outside is to the right of the edge when it is RIGHT */
+    Point normal = (this->outside == RIGHT) ? Point(edge.y, -edge.x)
+                                            : Point(-edge.y, edge.x);
+    add_half_plane(normal, normal.dot(A));
+  }
+}
+
+/**
+ * @brief Adds the half-plane normal . p <= offset to the obstacle.
+ *
+ * @param normal Outward normal of the half-plane.
+ * @param offset Offset of its boundary line along normal.
+ * @return Void.
+ */
+void Obstacle::add_half_plane(const Point &normal, double offset) {
+  this->normals.push_back(normal);
+  this->offsets.push_back(offset);
+  this->errbounds.push_back(HALF_PLANE_ERRBOUND * (fabs(normal.x) + fabs(normal.y)));
 }
 
 /**
@@ -106,13 +252,22 @@ vector<Point> get_convex_hull(const vector<Point> &polygon) {
           break; 
         }
       }
-      if(proper) {
+      /* Skip over points collinear with the edge by taking the farthest */
+      if(proper && (edge.find(i) == edge.end() ||
+                    polygon[i].dist(polygon[j]) > polygon[i].dist(polygon[edge[i]]))) {
         edge[i] = j;
       }
     }
   }
 
-  int first = edge.begin()->first;
+  /* Start from the lowest point, which is always a corner of the hull */
+  int first = 0;
+  for (int i = 1; i < n; i++) {
+    if (polygon[i].x < polygon[first].x ||
+        (polygon[i].x == polygon[first].x && polygon[i].y < polygon[first].y)) {
+      first = i;
+    }
+  }
   int idx = first;
   vector<Point> convex_hull;
   convex_hull.push_back(polygon[idx]);
@@ -153,67 +308,141 @@ Obstacle Obstacle::minkowski_sum(const Obstacle &o, double rad) {
 }
 
 /**
- * @brief Checks if the segment AB intersects the segment CD
+ * @brief Checks whether the given point p is inside the obstacle, i.e. on
+ * the inner side of every half-plane. A point certainly outside one of them
+ * is outside the obstacle. When none is certain and some slack is within
+ * its rounding error, the point is tested exactly instead.
  *
- * @param A Point A
- * @param B Point B
- * @param C Point C
- * @param D Point D
- * @return True if the segments intersect and False otherwise
+ * @param p A Point to check.
+ * @return True if the point lies on or inside the obstacle and false otherwise.
  */
-bool segments_intersect(const Point &A, const Point &B, 
-                        const Point &C, const Point &D) {
-  bool AB_opp_sides = (line_side_test(A, C, D) != line_side_test(B, C, D));
-  bool CD_opp_sides = (line_side_test(C, A, B) != line_side_test(D, A, B));
-  return AB_opp_sides && CD_opp_sides;
+bool Obstacle::collides(const Point &p) const {
+  if (p.x < this->lo.x || p.x > this->hi.x || p.y < this->lo.y || p.y > this->hi.y) {
+    return false;
+  }
+  double scale = this->extent + max(fabs(p.x), fabs(p.y));
+  int n = this->normals.size();
+  bool separated = false;
+  bool uncertain = false;
+  for (int i = 0; i < n; i++) {
+    double slack = this->offsets[i] - this->normals[i].dot(p);
+    double err = this->errbounds[i] * scale;
+    separated |= slack < -err;
+    uncertain |= fabs(slack) <= err;
+  }
+  if (separated) { return false; }
+  return !uncertain || exact_collides(p);
 }
 
 /**
- * @brief Checks whether the given point p is inside the obstacle. This only
- * works because the obstacle is assumed to be convex.
+ * @brief Checks whether the given point p is inside the obstacle, i.e. not
+ * on the outer side of any edge, with exact line-side tests. The caller has
+ * checked the bounding box, which keeps points collinear with a hull that
+ * has no area to the hull itself.
  *
  * @param p A Point to check.
  * @return True if the point lies on or inside the obstacle and false otherwise.
  */
-bool Obstacle::collides(const Point &p) const {
-  int n = this->convex_hull.size();
-
-  int cc_violations = 0; /* counter-clockwise assumption */
-  int c_violations = 0;  /* clockwise assumption */
-  for (int i = 0; i < n; i++) {
-    const Point &A = this->convex_hull[i];
-    const Point &B = this->convex_hull[(i+1) % n];
-
-    if(line_side_test(p, A, B) != RIGHT) {
-      cc_violations += 1;
-    }
-
-    if(line_side_test(p, A, B) != LEFT) {
-      c_violations += 1;
+bool Obstacle::exact_collides(const Point &p) const {
+  const vector<Point> &hull = this->convex_hull;
+  int n = hull.size();
+  for (int i = 0, prev = n - 1; i < n; prev = i++) {
+    if (line_side_test(p, hull[prev], hull[i]) == this->outside) {
+      return false;
     }
   }
-  return cc_violations == n || c_violations == n;
+  return true;
 }
 
 /**
- * @brief Checks whether the given point p is inside the obstacle. This only
- * works because the obstacle is assumed to be convex.
+ * @brief Checks whether the segment from p1 to p2 touches the obstacle.
+ * Segments whose bounding box misses the obstacle's are rejected first. The
+ * rest are clipped against every half-plane in one pass (Cyrus-Beck): the
+ * segment p1 + t (p2 - p1) enters a half-plane at some t and leaves it at
+ * another, and it touches the obstacle if the latest entry comes no later
+ * than the earliest exit. Segments lying wholly inside the obstacle collide
+ * as well.
+ *
+ * Every entry and exit is kept with its rounding error, so the latest entry
+ * and earliest exit are known to lie in intervals. The segment is tested
+ * exactly instead when those intervals overlap, or when the segment runs so
+ * nearly along an edge that the sign of its rate or slack is uncertain.
  *
  * @param p1 First point on path.
  * @param p2 Second point on path.
- * @return True if the point lies on or inside the obstacle and False otherwise.
+ * @return True if the segment lies on or inside the obstacle anywhere and
+ * false otherwise.
  */
 bool Obstacle::path_collides(const Point &p1, const Point &p2) const {
-  int n = this->convex_hull.size();
+  if (max(p1.x, p2.x) < this->lo.x || min(p1.x, p2.x) > this->hi.x ||
+      max(p1.y, p2.y) < this->lo.y || min(p1.y, p2.y) > this->hi.y) {
+    return false;
+  }
 
+  Point dir = p2 - p1;
+  double scale = this->extent + max(max(fabs(p1.x), fabs(p1.y)),
+                                    max(fabs(p2.x), fabs(p2.y)));
+  double length = max(fabs(dir.x), fabs(dir.y));
+  double enter_lo = 0, enter_hi = 0; /* Bounds on the latest entry */
+  double exit_lo = 1, exit_hi = 1;   /* Bounds on the earliest exit */
+  int n = this->normals.size();
   for (int i = 0; i < n; i++) {
-    const Point &A = this->convex_hull[i];
-    const Point &B = this->convex_hull[(i+1) % n];
+    double slack = this->offsets[i] - this->normals[i].dot(p1); /* >= 0 if p1 is inside */
+    double rate = this->normals[i].dot(dir);
+    double slack_err = this->errbounds[i] * scale;
+    double rate_err = this->errbounds[i] * length;
+    if (fabs(rate) <= 2 * rate_err) {
+      /* Nearly parallel, the slack at both ends decides */
+      double margin = slack_err + 3 * rate_err;
+      if (slack < -margin && slack - rate < -margin) { return false; }
+      if (slack > margin && slack - rate > margin) { continue; }
+      return exact_path_collides(p1, p2);
+    }
+    double inv = 1 / rate;
+    double t = slack * inv;
+    double t_err = 2 * (slack_err + fabs(t) * rate_err) * fabs(inv) + 3 * DBL_EPSILON * fabs(t);
+    if (rate > 0) {
+      exit_lo = min(exit_lo, t - t_err);
+      exit_hi = min(exit_hi, t + t_err);
+    } else {
+      enter_lo = max(enter_lo, t - t_err);
+      enter_hi = max(enter_hi, t + t_err);
+    }
+  }
+  if (enter_hi <= exit_lo) { return true; }
+  if (enter_lo > exit_hi) { return false; }
+  return exact_path_collides(p1, p2);
+}
 
-    if(segments_intersect(p1, p2, A, B)) {
-      return true;
+/**
+ * @brief Checks whether the segment from p1 to p2 touches the obstacle,
+ * using separating axes and exact line-side tests. Two convex shapes in the
+ * plane are disjoint exactly when a line parallel to an edge of one of them
+ * separates them, so the segment misses the obstacle exactly when its
+ * bounding box misses the obstacle's, or both ends are outside the same
+ * edge, or the whole hull is strictly on one side of the segment's line. Segments lying wholly inside
+ * the obstacle collide as well. The caller has checked the bounding boxes.
+ *
+ * @param p1 First point on path.
+ * @param p2 Second point on path.
+ * @return True if the segment lies on or inside the obstacle anywhere and
+ * false otherwise.
+ */
+bool Obstacle::exact_path_collides(const Point &p1, const Point &p2) const {
+  const vector<Point> &hull = this->convex_hull;
+  int n = hull.size();
+  int sides = 0; /* Bit per side of the segment's line a vertex is on */
+  for (int i = 0; i < n; i++) {
+    sides |= 1 << (line_side_test(hull[i], p1, p2) + 1);
+  }
+  if (sides == (1 << (LEFT + 1)) || sides == (1 << (RIGHT + 1))) {
+    return false;
+  }
+  for (int i = 0, prev = n - 1; i < n; prev = i++) {
+    if (line_side_test(p1, hull[prev], hull[i]) == this->outside &&
+        line_side_test(p2, hull[prev], hull[i]) == this->outside) {
+      return false;
     }
-    
   }
-  return false;
+  return true;
 }
@@ -11,6 +11,7 @@
 #ifndef __OBSTACLE_H
 #define __OBSTACLE_H
 
+#include <cfloat>
 #include <vector>
 
 #include "Point.h"
@@ -20,10 +21,34 @@
 #define ON 0
 #define RIGHT 1
 
+/* Relative error bound of the floating point line-side test, (3 + 16u)u
+ * for unit roundoff u = 2^-53 (Shewchuk's ccwerrboundA) */
+#define LINE_SIDE_ERRBOUND ((3.0 + 16.0 * DBL_EPSILON / 2) * DBL_EPSILON / 2)
+
+int line_side_test(const Point &test, const Point &A, const Point &B);
+
+/* Bound on the rounding error of a half-plane test, as a multiple of the
+ * size of its normal times the coordinates involved. 8u for unit roundoff
+ * u = 2^-53, twice what the dot products and the rounded normal can lose. */
+#define HALF_PLANE_ERRBOUND (8 * DBL_EPSILON / 2)
+
+/* Convex polygon, also kept as the intersection of half-planes
+ * normals[i] . p <= offsets[i] with outward normals, one per edge, and as
+ * its axis aligned bounding box [lo, hi]. Degenerate polygons with no area
+ * also get the sides of the box as half-planes, so the intersection stays
+ * bounded. Tests run on the half-planes in floating point and are redone
+ * with exact line-side tests when a value is within its rounding error. */
 class Obstacle {
   public:
     /* Data */
     vector<Point> convex_hull;
+    vector<Point> normals;
+    vector<double> offsets;
+    vector<double> errbounds; /* Rounding error per unit of coordinates */
+    Point lo;
+    Point hi;
+    double extent; /* Largest coordinate of the box in absolute value */
+    int outside;   /* Side of every edge, LEFT or RIGHT, facing away */
 
     /* Constructors */
     Obstacle(const vector<Point> &polygon);
@@ -33,7 +58,11 @@ class Obstacle {
     static Obstacle minkowski_sum(const Obstacle &o, double rad);
     bool collides(const Point &p) const;
     bool path_collides(const Point &p1, const Point &p2) const;
-    
+
+  private:
+    void add_half_plane(const Point &normal, double offset);
+    bool exact_collides(const Point &p) const;
+    bool exact_path_collides(const Point &p1, const Point &p2) const;
 };
 
 #endif /* __OBSTACLE_H */
@@ -0,0 +1,257 @@
+/**
+ *  @file PlanFile.cpp
+ *  @brief Implements the plan file writer and reader defined in PlanFile.h
+ *
+ *  @author Shashank Ojha (shashano)
+ *  @author Serris Lew (snlew)
+ *  @author David Bick (dbick)
+ *  @bug No known bugs.
+ */
+
+#include <cerrno>
+#include <stdexcept>
+#include <unordered_map>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#include "PlanFile.h"
+
+using namespace std;
+
+/**
+ * @brief Rounds a byte count up to a multiple of 8.
+ *
+ * @param n Byte count.
+ * @return Smallest multiple of 8 at least n.
+ */
+static uint64_t align8(uint64_t n) {
+  return (n + 7) & ~((uint64_t) 7);
+}
+
+/****************************************************************************/
+
+                              /* Plan Writer */
+
+/****************************************************************************/
+
+/**
+ * @brief Constructor that opens a plan file for appending, creating it if
+ * it does not exist.
+ *
+ * @param filename The file to append to.
+ * @return Writer for the file.
+ */
+PlanWriter::PlanWriter(const string &filename) {
+  this->fd = open(filename.c_str(), O_WRONLY | O_CREAT | O_APPEND, 0644);
+  if (this->fd < 0) {
+    throw invalid_argument("PlanWriter Constructor: Unable to open file!");
+  }
+}
+
+/**
+ * @brief Destructor. Closes the file.
+ */
+PlanWriter::~PlanWriter() {
+  close(this->fd);
+}
+
+/**
+ * @brief Numbers the vertices of a tree breadth first from root and records
+ * the parent and cost to come of each. Vertices that cannot be reached from
+ * root, like the goal side of an RRT-Connect search that never met, become
+ * roots of their own.
+ *
+ * @param tree Tree to flatten.
+ * @param root Vertex to number first, may be NULL.
+ * @return Void.
+ */
+void PlanWriter::flatten_tree(const Graph<Point> &tree, Point *root) {
+  this->nodes.clear();
+  this->parents.clear();
+  this->costs.clear();
+
+  unordered_map<Point*, int32_t> ids;
+  ids.reserve(tree.adj_list.size());
+  vector<Point*> order;
+  order.reserve(tree.adj_list.size());
+
+  auto visit_from = [&](Point *r) {
+    if (!ids.insert({r, (int32_t) order.size()}).second) { return; }
+    order.push_back(r);
+    this->parents.push_back(-1);
+    this->costs.push_back(0);
+    for (size_t i = order.size() - 1; i < order.size(); i++) {
+      Point *u = order[i];
+      for (Point *v : tree.get_neighbors(u)) {
+        if (!ids.insert({v, (int32_t) order.size()}).second) { continue; }
+        order.push_back(v);
+        this->parents.push_back(i);
+        this->costs.push_back(this->costs[i] + u->dist(*v));
+      }
+    }
+  };
+
+  if (root != NULL && tree.adj_list.count(root) > 0) { visit_from(root); }
+  for (const auto &adj : tree.adj_list) {
+    if (adj.first != NULL) { visit_from(adj.first); }
+  }
+
+  for (Point *p : order) {
+    this->nodes.push_back(*p);
+  }
+}
+
+/**
+ * @brief Appends one record with a single vectored write.
+ *
+ * @param path Points of the path.
+ * @param tree Tree the path was found in, or NULL to only write the path.
+ * @param root Root of the tree, usually the start.
+ * @param converged False if path only leads to the closest approach.
+ * @param iterations Iterations the planner ran.
+ * @return True if the whole record was written and false otherwise.
+ */
+bool PlanWriter::write(const vector<Point*> &path, const Graph<Point> *tree, Point *root,
+                       bool converged, int iterations) {
+  this->path.clear();
+  double path_cost = 0;
+  for (size_t i = 0; i < path.size(); i++) {
+    this->path.push_back(*path[i]);
+    if (i > 0) { path_cost += path[i - 1]->dist(*path[i]); }
+  }
+  if (tree != NULL) {
+    this->flatten_tree(*tree, root);
+  } else {
+    this->nodes.clear();
+    this->parents.clear();
+    this->costs.clear();
+  }
+
+  uint64_t num_nodes = this->nodes.size();
+  uint64_t parents_bytes = num_nodes * sizeof(int32_t);
+  uint64_t padding = align8(parents_bytes) - parents_bytes;
+
+  Plan_Record_Header header;
+  header.magic = PLAN_FILE_MAGIC;
+  header.version = PLAN_FILE_VERSION;
+  header.num_path = this->path.size();
+  header.num_nodes = num_nodes;
+  header.converged = converged;
+  header.iterations = iterations;
+  header.path_cost = path_cost;
+  header.record_size = sizeof(header) + this->path.size() * sizeof(Point) +
+                       num_nodes * sizeof(Point) + parents_bytes + padding +
+                       num_nodes * sizeof(double);
+
+  static const char zeros[8] = {0};
+  struct iovec iov[6] = {
+    {&header, sizeof(header)},
+    {this->path.data(), this->path.size() * sizeof(Point)},
+    {this->nodes.data(), num_nodes * sizeof(Point)},
+    {this->parents.data(), parents_bytes},
+    {(void *) zeros, padding},
+    {this->costs.data(), num_nodes * sizeof(double)},
+  };
+
+  /* Resume short writes where they stopped */
+  struct iovec *next = iov;
+  int count = 6;
+  while (count > 0) {
+    ssize_t n = writev(this->fd, next, count);
+    if (n < 0 && errno == EINTR) { continue; }
+    if (n < 0) { return false; }
+    while (count > 0 && (size_t) n >= next->iov_len) {
+      n -= next->iov_len;
+      next++;
+      count--;
+    }
+    if (count > 0) {
+      next->iov_base = (char *) next->iov_base + n;
+      next->iov_len -= n;
+    }
+  }
+  return true;
+}
+
+/****************************************************************************/
+
+                               /* Plan File */
+
+/****************************************************************************/
+
+/**
+ * @brief Constructor that maps a plan file and checks every record header.
+ *
+ * @param filename The file to read.
+ * @return Mapped file with a view of each record.
+ */
+PlanFile::PlanFile(const string &filename) {
+  this->data = NULL;
+  this->size = 0;
+
+  int fd = open(filename.c_str(), O_RDONLY);
+  if (fd < 0) {
+    throw invalid_argument("PlanFile Constructor: Unable to open file!");
+  }
+  struct stat st;
+  if (fstat(fd, &st) < 0) {
+    close(fd);
+    throw invalid_argument("PlanFile Constructor: Unable to stat file!");
+  }
+  this->size = st.st_size;
+  if (this->size > 0) {
+    void *mapped = mmap(NULL, this->size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (mapped == MAP_FAILED) {
+      close(fd);
+      throw invalid_argument("PlanFile Constructor: Unable to map file!");
+    }
+    this->data = (const char *) mapped;
+  }
+  close(fd);
+
+  uint64_t offset = 0;
+  while (offset < this->size) {
+    const Plan_Record_Header *header = (const Plan_Record_Header *) (this->data + offset);
+    uint64_t remaining = this->size - offset;
+    if (remaining < sizeof(Plan_Record_Header) || header->magic != PLAN_FILE_MAGIC ||
+        header->version != PLAN_FILE_VERSION || header->record_size > remaining) {
+      munmap((void *) this->data, this->size);
+      throw invalid_argument("PlanFile Constructor: Corrupt record!");
+    }
+
+    uint64_t num_nodes = header->num_nodes;
+    uint64_t needed = sizeof(Plan_Record_Header) + header->num_path * sizeof(Point) +
+                      num_nodes * sizeof(Point) + align8(num_nodes * sizeof(int32_t)) +
+                      num_nodes * sizeof(double);
+    if (needed != header->record_size) {
+      munmap((void *) this->data, this->size);
+      throw invalid_argument("PlanFile Constructor: Corrupt record!");
+    }
+
+    const char *section = (const char *) (header + 1);
+    Plan_Record record;
+    record.header = header;
+    record.path = (const Point *) section;
+    section += header->num_path * sizeof(Point);
+    record.nodes = (const Point *) section;
+    section += num_nodes * sizeof(Point);
+    record.parents = (const int32_t *) section;
+    section += align8(num_nodes * sizeof(int32_t));
+    record.costs = (const double *) section;
+    this->records.push_back(record);
+
+    offset += header->record_size;
+  }
+}
+
+/**
+ * @brief Destructor. Unmaps the file, which invalidates every record view.
+ */
+PlanFile::~PlanFile() {
+  if (this->data != NULL) { munmap((void *) this->data, this->size); }
+}
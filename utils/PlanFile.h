@@ -0,0 +1,100 @@
+/**
+ *  @file PlanFile.h
+ *  @brief Defines a compact binary format for plans and the trees they were
+ *  found in, a writer that appends a plan to a file with one vectored write
+ *  and a reader that maps the file and hands out views into it without
+ *  copying.
+ *
+ *  A plan file is a sequence of records. Each record is a Plan_Record_Header
+ *  followed by these sections, each starting 8-byte aligned:
+ *    path     num_path Points
+ *    nodes    num_nodes Points, in breadth first order from the root
+ *    parents  num_nodes int32_t, index of the parent node or -1 for a root
+ *    costs    num_nodes doubles, distance from the root along the tree
+ *  Parents always come before their children. All fields are in host byte
+ *  order.
+ *
+ *  @author Shashank Ojha (shashano)
+ *  @author Serris Lew (snlew)
+ *  @author David Bick (dbick)
+ *  @bug No known bugs.
+ */
+
+#ifndef __PLAN_FILE_H
+#define __PLAN_FILE_H
+
+#include <cstdint>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "Graph.h"
+#include "Point.h"
+
+#define PLAN_FILE_MAGIC 0x4e414c50 /* "PLAN" */
+#define PLAN_FILE_VERSION 1
+
+using namespace std;
+
+static_assert(sizeof(Point) == 2 * sizeof(double) && is_trivially_copyable<Point>::value,
+              "Points are written and mapped as pairs of doubles");
+
+struct Plan_Record_Header {
+  uint32_t magic;
+  uint32_t version;
+  uint64_t record_size; /* Bytes from this header to the next one */
+  uint32_t num_path;
+  uint32_t num_nodes;   /* 0 if the tree was not written */
+  uint32_t converged;
+  uint32_t iterations;
+  double path_cost;
+};
+
+/* Views into one record of a mapped plan file */
+struct Plan_Record {
+  const Plan_Record_Header *header;
+  const Point *path;
+  const Point *nodes;
+  const int32_t *parents;
+  const double *costs;
+};
+
+/* Appends records to a plan file. Buffers are kept between writes, so
+ * logging every plan only allocates while plans keep getting bigger. */
+class PlanWriter {
+  public:
+    /* Data */
+    int fd;
+    vector<Point> path;
+    vector<Point> nodes;
+    vector<int32_t> parents;
+    vector<double> costs;
+
+    /* Constructors */
+    PlanWriter(const string &filename);
+    PlanWriter(const PlanWriter &other) = delete;
+    ~PlanWriter();
+
+    /* Function Prototypes */
+    bool write(const vector<Point*> &path, const Graph<Point> *tree, Point *root,
+               bool converged, int iterations);
+
+  private:
+    void flatten_tree(const Graph<Point> &tree, Point *root);
+};
+
+/* Read-only mapping of a plan file */
+class PlanFile {
+  public:
+    /* Data */
+    const char *data;
+    size_t size;
+    vector<Plan_Record> records;
+
+    /* Constructors */
+    PlanFile(const string &filename);
+    PlanFile(const PlanFile &other) = delete;
+    ~PlanFile();
+};
+
+#endif /* __PLAN_FILE_H */
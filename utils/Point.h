@@ -1,9 +1,12 @@
-/* Point class to store (x, y) points and some utility functions for them */
-
 /**
- *  @file Obstacle.h
- *  @brief Defines a class Point to keep track of (x,y) points and utility
- *  functions for them
+ *  @file Point.h
+ *  @brief Defines a class PointT to keep track of points in D dimensions and
+ *  some utility functions for them. Point is the planar, double precision
+ *  instantiation used throughout the planner.
+ *
+ *  NOTE: The implementation is also found in this file instead of a separate
+ *  cpp file. This is necessary for templates. For more information see:
+ *    https://isocpp.org/wiki/faq/templates#templates-defn-vs-decl
  *
  *  @author Shashank Ojha (shashano)
  *  @author Serris Lew (snlew)
@@ -14,53 +17,288 @@
 #ifndef __POINT_H
 #define __POINT_H
 
+#include <cmath>
+#include <functional>
+#include <iomanip>
 #include <iostream>
 
+#include "Memory.h"
+
 using namespace std;
 
 #define POINT_EPSILON 0.000000001
 
-class Point {
+/* Coordinates of a point in D dimensions */
+template <int D, typename Scalar>
+class Coordinates {
   public:
     /* Data */
-    double x;
-    double y;
+    Scalar coords[D];
 
-    /* Constructors */
-    Point();
-    Point(double x, double y);
-    Point(const Point &other);
+    /* Function Prototypes */
+    Scalar& operator [] (int dimension) { return this->coords[dimension]; }
+    Scalar operator [] (int dimension) const { return this->coords[dimension]; }
+    template <int I> Scalar get() const { return this->coords[I]; }
+};
+
+/* Planar coordinates keep their names, since the maps are planar */
+template <typename Scalar>
+class Coordinates<2, Scalar> {
+  public:
+    /* Data */
+    Scalar x;
+    Scalar y;
+
+    /* Members by dimension, so that indexing is a load and not a branch */
+    static constexpr Scalar Coordinates::* members[2] = {&Coordinates::x, &Coordinates::y};
 
     /* Function Prototypes */
-    Point operator + (const Point &other) const;
-    Point operator - (const Point &other) const;
-    bool operator == (const Point &other) const;
-    double operator [] (int dimension) const;
+    Scalar& operator [] (int dimension) { return this->*members[dimension]; }
+    Scalar operator [] (int dimension) const { return this->*members[dimension]; }
+    template <int I> Scalar get() const {
+      static_assert(I == 0 || I == 1, "Planar points have dimensions 0 and 1");
+      return (I == 0) ? this->x : this->y;
+    }
+};
 
+template <int D, typename Scalar = double>
+class PointT : public Coordinates<D, Scalar> {
+  public:
+    /* Constructors */
+    PointT();
+    PointT(Scalar x, Scalar y);
+    PointT(Scalar x, Scalar y, Scalar z);
 
-    double dot(const Point &other) const;
-    double cross(const Point &other) const;
-    double dist(const Point &other) const;
-    double angle(const Point &other) const;
+    /* Function Prototypes */
+    PointT operator + (const PointT &other) const;
+    PointT operator - (const PointT &other) const;
+    bool operator == (const PointT &other) const;
 
-    Point normalize() const;
-    Point scale(double s) const;
+    Scalar dot(const PointT &other) const;
+    Scalar cross(const PointT &other) const;
+    Scalar dist(const PointT &other) const;
+    Scalar angle(const PointT &other) const;
 
-    bool equals(Point *other);
-    double at(int dimension);
+    PointT normalize() const;
+    PointT scale(Scalar s) const;
 
-    /* Output Stream Definition */
-    friend ostream& operator<<(ostream& os, const Point& p);
+    /* Points made with new are counted, see Memory.h */
+    static void *operator new(size_t size) { return counted_new(size); }
+    static void operator delete(void *p, size_t size) { counted_delete(p, size); }
 };
 
+typedef PointT<2, double> Point;
+
 /* Default Hash Function */
-template<>
-struct hash<Point>
-{
-  size_t operator()(const Point &obj) const
+namespace std {
+  template <int D, typename Scalar>
+  struct hash<PointT<D, Scalar>>
   {
-    return obj.x;
+    size_t operator()(const PointT<D, Scalar> &obj) const
+    {
+      return obj[0];
+    }
+  };
+}
+
+/****************************************************************************/
+
+                            /* Implementation */
+
+/****************************************************************************/
+
+/**
+ * @brief Default constructor.
+ *
+ * @return Point at the origin.
+ */
+template <int D, typename Scalar>
+PointT<D, Scalar>::PointT() {
+  for (int i = 0; i < D; i++) {
+    (*this)[i] = 0;
   }
-};
+}
+
+/**
+ * @brief Constructor for a given point at a given location in the plane.
+ *
+ * @param x Coordinate value.
+ * @param y Coordinate value.
+ * @return Point at (x, y).
+ */
+template <int D, typename Scalar>
+PointT<D, Scalar>::PointT(Scalar x, Scalar y) {
+  static_assert(D == 2, "Only planar points are made from two coordinates");
+  (*this)[0] = x;
+  (*this)[1] = y;
+}
+
+/**
+ * @brief Constructor for a given point at a given location in space, or a
+ * planar pose with heading z.
+ *
+ * @param x Coordinate value.
+ * @param y Coordinate value.
+ * @param z Coordinate value.
+ * @return Point at (x, y, z).
+ */
+template <int D, typename Scalar>
+PointT<D, Scalar>::PointT(Scalar x, Scalar y, Scalar z) {
+  static_assert(D == 3, "Only 3D points are made from three coordinates");
+  (*this)[0] = x;
+  (*this)[1] = y;
+  (*this)[2] = z;
+}
+
+/**
+ * @brief Takes vector sum of two points.
+ *
+ * @param other Point to add.
+ * @return Point containing sum of this point and other point.
+ */
+template <int D, typename Scalar>
+PointT<D, Scalar> PointT<D, Scalar>::operator + (const PointT &other) const {
+  PointT res;
+  for (int i = 0; i < D; i++) {
+    res[i] = (*this)[i] + other[i];
+  }
+  return res;
+}
+
+/**
+ * @brief Takes vector difference of two points.
+ *
+ * @param other Point to subtract.
+ * @return Point containing difference between this point and other point.
+ */
+template <int D, typename Scalar>
+PointT<D, Scalar> PointT<D, Scalar>::operator - (const PointT &other) const {
+  PointT res;
+  for (int i = 0; i < D; i++) {
+    res[i] = (*this)[i] - other[i];
+  }
+  return res;
+}
+
+/**
+ * @brief Checks for equality between points. We define equality between
+ * coordinates if their absolute difference is less than POINT_EPSILON.
+ *
+ * @param other Point to check equality against.
+ * @return True if equal and false otherwise.
+ */
+template <int D, typename Scalar>
+bool PointT<D, Scalar>::operator == (const PointT &other) const {
+  for (int i = 0; i < D; i++) {
+    if (fabs((*this)[i] - other[i]) >= POINT_EPSILON) { return false; }
+  }
+  return true;
+}
+
+/**
+ * @brief Computes dot product of two points.
+ *
+ * @param other Point to dot against.
+ * @return Dot product of two points.
+ */
+template <int D, typename Scalar>
+Scalar PointT<D, Scalar>::dot(const PointT &other) const {
+  Scalar sum = 0;
+  for (int i = 0; i < D; i++) {
+    sum += (*this)[i] * other[i];
+  }
+  return sum;
+}
+
+/**
+ * @brief Computes cross product of two planar points.
+ *
+ * @param other Point to cross against.
+ * @return Cross product of two points.
+ */
+template <int D, typename Scalar>
+Scalar PointT<D, Scalar>::cross(const PointT &other) const {
+  static_assert(D == 2, "The scalar cross product is only defined in the plane");
+  return (this->x * other.y) - (other.x * this->y);
+}
+
+/**
+ * @brief Computes distance between two points.
+ *
+ * @param other Point to measure the distance to.
+ * @return Distance between two points.
+ */
+template <int D, typename Scalar>
+Scalar PointT<D, Scalar>::dist(const PointT &other) const {
+  PointT delta = other - *this;
+  return sqrt(delta.dot(delta));
+}
+
+/**
+ * @brief Computes angle between two planar points.
+ *
+ * @param other Point to find the angle to.
+ * @return Angle between horizontal at current point and other point in radians.
+ */
+template <int D, typename Scalar>
+Scalar PointT<D, Scalar>::angle(const PointT &other) const {
+  static_assert(D == 2, "Angles to the horizontal are only defined in the plane");
+  Scalar r = this->dist(other);
+  Scalar dx = other.x - this->x;
+  Scalar angle = acos(dx / r);
+  if (this->y > other.y) {
+    angle *= -1;
+  }
+  return angle;
+}
+
+/**
+ * @brief Normalizes the point to unit length.
+ *
+ * @return Normalized point.
+ */
+template <int D, typename Scalar>
+PointT<D, Scalar> PointT<D, Scalar>::normalize() const {
+  Scalar norm = sqrt(this->dot(*this));
+  PointT res;
+  for (int i = 0; i < D; i++) {
+    res[i] = (*this)[i] / norm;
+  }
+  return res;
+}
+
+/**
+ * @brief Scales the point by s.
+ *
+ * @param s Scale factor.
+ * @return Scaled point.
+ */
+template <int D, typename Scalar>
+PointT<D, Scalar> PointT<D, Scalar>::scale(Scalar s) const {
+  PointT res;
+  for (int i = 0; i < D; i++) {
+    res[i] = s * (*this)[i];
+  }
+  return res;
+}
+
+/**
+ * @brief Adds support for printing Points.
+ *
+ * @param os Output stream.
+ * @param p Point Object.
+ * @return New output stream with point inside stream.
+ */
+template <int D, typename Scalar>
+ostream& operator<<(ostream& os, const PointT<D, Scalar>& p) {
+  os << fixed;
+  os << setprecision(3);
+  os << "(";
+  for (int i = 0; i < D; i++) {
+    os << (i == 0 ? "" : ", ") << p[i];
+  }
+  os << ")";
+  return os;
+}
 
 #endif /* __POINT_H */
@@ -0,0 +1,53 @@
+/**
+ *  @file Random.h
+ *  @brief Defines the random numbers the samplers and planners draw. Every
+ *  thread has its own generator, so planners on different threads do not
+ *  contend for the lock inside rand() or draw from each other's sequence,
+ *  and seeding a thread with the same seed repeats the samples of a plan.
+ *  Threads that are never seeded start from a seed of their own.
+ *
+ *  @author Shashank Ojha (shashano)
+ *  @author Serris Lew (snlew)
+ *  @author David Bick (dbick)
+ *  @bug No known bugs.
+ */
+
+#ifndef __RANDOM_H
+#define __RANDOM_H
+
+#include <cstdint>
+#include <random>
+
+using namespace std;
+
+inline thread_local mt19937 thread_rng(random_device{}());
+
+/**
+ * @brief Restarts the calling thread's generator.
+ *
+ * @param seed Seed, the same seed gives the same numbers.
+ * @return Void.
+ */
+inline void seed_random(uint32_t seed) {
+  thread_rng.seed(seed);
+}
+
+/**
+ * @brief Draws from the calling thread's generator.
+ *
+ * @return Uniform number in [0, 1].
+ */
+inline double random_unit() {
+  return (double) thread_rng() / mt19937::max();
+}
+
+/**
+ * @brief Draws from the calling thread's generator, never 0, for logs.
+ *
+ * @return Uniform number in (0, 1].
+ */
+inline double random_unit_open() {
+  return ((double) thread_rng() + 1) / ((double) mt19937::max() + 1);
+}
+
+#endif /* __RANDOM_H */
@@ -0,0 +1,129 @@
+/**
+ *  @file RingBuffer.h
+ *  @brief Defines a lock-free ring buffer for one producer and one consumer
+ *  thread
+ *
+ *  NOTE: The implementation is also found in this file instead of a separate
+ *  cpp file. This is necessary for templates. For more information see:
+ *    https://isocpp.org/wiki/faq/templates#templates-defn-vs-decl
+ *
+ *  @author Shashank Ojha (shashano)
+ *  @author Serris Lew (snlew)
+ *  @author David Bick (dbick)
+ *  @bug No known bugs.
+ */
+
+#ifndef __RING_BUFFER_H
+#define __RING_BUFFER_H
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <cstddef>
+#include <vector>
+
+/* Keeps the indices written by different threads on different cache lines */
+#define CACHE_LINE 64
+
+using namespace std;
+
+/* Bounded queue where exactly one thread pushes and exactly one other thread
+ * pops. Neither side ever blocks or takes a lock: push fails when the buffer
+ * is full and pop returns nothing when it is empty. Each side keeps a cached
+ * copy of the other side's index and only reads the shared one when the
+ * cache says it has run out of room or items. */
+template <typename T>
+class RingBuffer {
+  public:
+    /* Constructors */
+    RingBuffer(size_t capacity);
+    RingBuffer(const RingBuffer &other) = delete;
+
+    /* Function Prototypes */
+    size_t capacity() const;
+    bool push(const T &item);
+    size_t pop(T *items, size_t max_items);
+
+  private:
+    /* Data */
+    vector<T> slots;
+    size_t mask;
+    alignas(CACHE_LINE) atomic<size_t> head; /* Next slot to pop, moved by the consumer */
+    size_t cached_tail;                      /* Consumer's copy of tail */
+    alignas(CACHE_LINE) atomic<size_t> tail; /* Next slot to push, moved by the producer */
+    size_t cached_head;                      /* Producer's copy of head */
+};
+
+/****************************************************************************/
+
+                            /* Implementation */
+
+/****************************************************************************/
+
+/**
+ * @brief Constructor for an empty buffer.
+ *
+ * @param capacity Number of slots, a power of two.
+ * @return Empty buffer.
+ */
+template <typename T>
+RingBuffer<T>::RingBuffer(size_t capacity)
+  : slots(capacity), head(0), tail(0) {
+  assert(capacity > 0 && (capacity & (capacity - 1)) == 0);
+  this->mask = capacity - 1;
+  this->cached_tail = 0;
+  this->cached_head = 0;
+}
+
+/**
+ * @brief Number of items the buffer can hold.
+ *
+ * @return Capacity.
+ */
+template <typename T>
+size_t RingBuffer<T>::capacity() const {
+  return this->slots.size();
+}
+
+/**
+ * @brief Adds an item. Only called by the producer.
+ *
+ * @param item Item to copy in.
+ * @return True if it was added and false if the buffer is full.
+ */
+template <typename T>
+bool RingBuffer<T>::push(const T &item) {
+  size_t t = this->tail.load(memory_order_relaxed);
+  if (t - this->cached_head == this->slots.size()) {
+    this->cached_head = this->head.load(memory_order_acquire);
+    if (t - this->cached_head == this->slots.size()) { return false; }
+  }
+  this->slots[t & this->mask] = item;
+  this->tail.store(t + 1, memory_order_release);
+  return true;
+}
+
+/**
+ * @brief Removes up to max_items items, oldest first. Only called by the
+ * consumer.
+ *
+ * @param items Array to copy items into.
+ * @param max_items Size of items.
+ * @return Number of items removed.
+ */
+template <typename T>
+size_t RingBuffer<T>::pop(T *items, size_t max_items) {
+  size_t h = this->head.load(memory_order_relaxed);
+  if (this->cached_tail == h) {
+    this->cached_tail = this->tail.load(memory_order_acquire);
+    if (this->cached_tail == h) { return 0; }
+  }
+  size_t n = min(max_items, this->cached_tail - h);
+  for (size_t i = 0; i < n; i++) {
+    items[i] = this->slots[(h + i) & this->mask];
+  }
+  this->head.store(h + n, memory_order_release);
+  return n;
+}
+
+#endif /* __RING_BUFFER_H */
@@ -5,7 +5,7 @@
  *  NOTE: The implementation is also found in this file instead of a separate
  *  cpp file. This is necessary for templates. For more information see:
  *    https://isocpp.org/wiki/faq/templates#templates-defn-vs-decl
- * 
+ *
  *  @author Shashank Ojha (shashano)
  *  @author Serris Lew (snlew)
  *  @author David Bick (dbick)
@@ -15,145 +15,285 @@
 #ifndef __SEARCH_H
 #define __SEARCH_H
 
-#include <queue>
+#include <algorithm>
+#include <iostream>
 #include <unordered_map>
-#include <unordered_set>
 #include <vector>
 
 #include "Graph.h"
+#include "IndexedHeap.h"
+#include "Trace.h"
+
+/* Number of children per node of the open list's heap */
+#define SEARCH_HEAP_ARITY 4
 
-/* Class to keep track of information related to visited states */
-template <typename Node> 
-class State {
+/* A* search over graphs with dense integer ids. All per node state lives in
+ * flat arrays indexed by id that are kept between queries, so one engine
+ * answering many queries on the same roadmap only allocates on the first.
+ *
+ * The graph is any type with the interface of FrozenGraph: num_vertices(),
+ * node(id) and neighbors(id) returning edges with a target id and a cost. */
+template <typename Node>
+class AStar {
   public:
     /* Data */
-    Node *data;
-    Node *parent;
-    double cost;
-    double g;
+    IndexedHeap<SEARCH_HEAP_ARITY> open; /* Keyed by cost plus heuristic */
+    vector<double> costs;
+    vector<int> parents;
+    vector<unsigned> seen;   /* Query in which costs and parents were set */
+    vector<unsigned> closed; /* Query in which the node was expanded */
+    unsigned query;
+    int num_expanded;        /* Nodes expanded by the last query */
 
     /* Constructors */
-    State(Node *data, Node *parent, double cost, double g);
+    AStar();
+
+    /* Function Prototypes */
+    template <typename Dense>
+    vector<int> search(Dense &g, int start, int target,
+                       double heuristic(Node *n, Node *target));
+
+  private:
+    void begin_query(int num_vertices);
 };
 
-template <typename Node> 
+/* View of a Graph that numbers its vertices in the order a search reaches
+ * them, for one-off searches where numbering the whole graph up front would
+ * cost more than the search itself. */
+template <typename Node>
+class LazyDenseGraph {
+  public:
+    /* Data */
+    const Graph<Node> &graph;
+    vector<Node*> vertices;
+    unordered_map<Node*, int> ids;
+    vector<Dense_Edge> edges; /* Edges of the last vertex asked for */
+
+    /* Constructors */
+    LazyDenseGraph(const Graph<Node> &g);
+
+    /* Function Prototypes */
+    int num_vertices() const;
+    int id(Node *n);
+    Node* node(int id) const;
+    const vector<Dense_Edge>& neighbors(int id);
+};
+
+template <typename Node>
 class Search {
   public:
     /* Function Prototypes */
-    static vector<Node*> a_star(Node *start, Node *target, 
-                                Graph<Node> &g, 
+    static vector<Node*> a_star(Node *start, Node *target,
+                                Graph<Node> &g,
                                 double heuristic(Node* n, Node *target));
 };
 
 /****************************************************************************/
 
-                          /* Node Implementation */
+                            /* A* Engine */
 
 /****************************************************************************/
 
+/**
+ * @brief Constructor for an engine that has not searched yet.
+ *
+ * @return Engine with empty scratch arrays.
+ */
+template <typename Node>
+AStar<Node>::AStar() {
+  this->query = 0;
+  this->num_expanded = 0;
+}
 
 /**
- * @brief Constructor for a state
- * 
- * @param data Pointer to data.
- * @param parent Pointer to parent.
- * @param cost True cost to node.
- * @param g Estimated cost to goal going through this node.
- * @return New output stream with graph inside stream.
+ * @brief Grows the scratch arrays to fit the graph and starts a new query.
+ * Entries from older queries are told apart by their query number, so
+ * nothing is cleared here.
+ *
+ * @param num_vertices Number of vertices of the graph about to be searched.
+ * @return Void.
  */
-template <typename Node> 
-State<Node>::State(Node *data, Node *parent, double cost, double g) {
-  this->data = data;
-  this->parent = parent;
-  this->cost = cost;
-  this->g = g;
+template <typename Node>
+void AStar<Node>::begin_query(int num_vertices) {
+  if ((int) this->seen.size() < num_vertices) {
+    this->costs.resize(num_vertices);
+    this->parents.resize(num_vertices);
+    this->seen.resize(num_vertices, 0);
+    this->closed.resize(num_vertices, 0);
+  }
+  this->open.reserve(num_vertices);
+  this->open.clear();
+  this->num_expanded = 0;
+
+  this->query += 1;
+  if (this->query == 0) { /* Wrapped around, so stamps are ambiguous */
+    fill(this->seen.begin(), this->seen.end(), 0);
+    fill(this->closed.begin(), this->closed.end(), 0);
+    this->query = 1;
+  }
 }
 
 /**
- * @brief Priority function to determine which order to visit states.
- * 
- * Note: PQ pick element from the right (which should be the smallest 
- *  given our ordering).
- * 
- * @param A State 1.
- * @param A State 2.
- * @return True if B has priority over A (minheap).
+ * @brief Computes A* search with the given heuristic from start to target.
+ * Nodes on the open list have their key lowered in place when a cheaper
+ * path to them is found. With a consistent heuristic a node is never
+ * expanded twice.
+ *
+ * @param g Frozen graph to search in.
+ * @param start Id of the initial state.
+ * @param target Id of the final state.
+ * @param heuristic heuristic function to aid search.
+ * @return Ids from start to target, or empty if target is unreachable.
  */
-template <typename Node> 
-struct priority {
-  size_t operator()(const State<Node> &A, const State<Node> &B) const {
-    return A.g > B.g;  // Compare estimated g values
+template <typename Node>
+template <typename Dense>
+vector<int> AStar<Node>::search(Dense &g, int start, int target,
+                                double heuristic(Node *n, Node *target)) {
+  this->begin_query(g.num_vertices());
+  Node *target_node = g.node(target);
+
+  this->costs[start] = 0;
+  this->parents[start] = -1;
+  this->seen[start] = this->query;
+  this->open.push(start, heuristic(g.node(start), target_node));
+
+  while (!this->open.empty()) {
+    int u = this->open.pop_min();
+    this->closed[u] = this->query;
+    this->num_expanded += 1;
+
+    if (u == target) {
+      vector<int> path;
+      for (int v = target; v != -1; v = this->parents[v]) {
+        path.push_back(v);
+      }
+      reverse(path.begin(), path.end());
+      return path;
+    }
+
+    for (const auto &edge : g.neighbors(u)) {
+      int v = edge.to;
+      if (this->closed[v] == this->query) { continue; }
+      double cost = this->costs[u] + edge.cost;
+      if (this->seen[v] == this->query && cost >= this->costs[v]) { continue; }
+
+      double key = cost + heuristic(g.node(v), target_node);
+      this->costs[v] = cost;
+      this->parents[v] = u;
+      if (this->seen[v] == this->query) { /* Seen but not closed is open */
+        this->open.decrease_key(v, key);
+      } else {
+        this->seen[v] = this->query;
+        this->open.push(v, key);
+      }
+    }
   }
-};
+  return vector<int>();
+}
 
 /****************************************************************************/
 
-                            /* Search Functions */
+                          /* Lazy Dense Graph */
 
 /****************************************************************************/
 
 /**
- * @brief Backtraces up the parents to find full path to target.
- * 
- * @param parents Map of parent pointers.
- * @param target Final state in path.
- * @return Full path of states from start to target.
+ * @brief Constructor for a view of g with no vertex numbered yet.
+ *
+ * @param g Graph to number, must not change while the view is in use.
+ * @return View of g.
  */
-template <typename Node> 
-vector<Node*> backtrace(unordered_map<Node*, Node*>& parents, Node* target) {
-  vector<Node*> path;
-  path.push_back(target);
-  while (parents[target] != NULL) {
-    target = parents[target];
-    path.push_back(target);
-  }
+template <typename Node>
+LazyDenseGraph<Node>::LazyDenseGraph(const Graph<Node> &g) : graph(g) {}
 
-  reverse(path.begin(), path.end());
-  return path;
+/**
+ * @brief Upper bound on the ids handed out, the size of the graph.
+ *
+ * @return Number of vertices of the graph.
+ */
+template <typename Node>
+int LazyDenseGraph<Node>::num_vertices() const {
+  return this->graph.adj_list.size();
 }
 
+/**
+ * @brief Looks up the id of a Node, numbering it if it has none yet.
+ *
+ * @param n Pointer to a vertex of the graph.
+ * @return Id of n.
+ */
+template <typename Node>
+int LazyDenseGraph<Node>::id(Node *n) {
+  auto inserted = this->ids.insert({n, (int) this->vertices.size()});
+  if (inserted.second) { this->vertices.push_back(n); }
+  return inserted.first->second;
+}
+
+/**
+ * @brief Looks up the Node with an id.
+ *
+ * @param id An id handed out by this view.
+ * @return Pointer to the Node.
+ */
+template <typename Node>
+Node* LazyDenseGraph<Node>::node(int id) const {
+  return this->vertices[id];
+}
+
+/**
+ * @brief Returns the edges out of a vertex, numbering their other ends.
+ *
+ * @param id An id handed out by this view.
+ * @return Edges with the id of the other end and their cost, valid until
+ * the next call.
+ */
+template <typename Node>
+const vector<Dense_Edge>& LazyDenseGraph<Node>::neighbors(int id) {
+  Node *from = this->vertices[id];
+  this->edges.clear();
+  for (Node *to : this->graph.get_neighbors(from)) {
+    this->edges.push_back({this->id(to), from->dist(*to)});
+  }
+  return this->edges;
+}
+
+/****************************************************************************/
+
+                            /* Search Functions */
+
+/****************************************************************************/
+
 /**
  * @brief Computes A* search with the given heuristic from start to target
- * using the provided Graph.
- * 
+ * using the provided Graph. Only the vertices the search reaches are
+ * numbered, but callers searching the same graph repeatedly should freeze
+ * it once and keep an AStar engine around instead.
+ *
  * @param start Initial state in path.
  * @param target Final state in path.
  * @param g Graph to search in.
  * @param heuristic heuristic function to aid search.
  * @return Full path of states from start to target or error if not found.
  */
-template <typename Node> 
+template <typename Node>
 vector<Node*> Search<Node>::a_star(Node *start, Node *target,
                                    Graph<Node> &g,
-                                   double heuristic(Node* n, Node* targset)) {
-  priority_queue<State<Node>, vector<State<Node>>, priority<Node>> frontier;
-  unordered_map<Node*, Node*> parents;
-  unordered_set<Node*> visited;
-  frontier.push(State<Node>(start, NULL, 0, 0));
-
-  while (!frontier.empty()) {
-    const State<Node> state = frontier.top();
-    frontier.pop();
-
-    if(visited.find(state.data) != visited.end()) { continue; }
-
-    parents[state.data] = state.parent;
-    visited.insert(state.data);
-
-    if (state.data == target) { return backtrace(parents, target); }
-
-    for (Node *neighbor : g.get_neighbors(state.data)) {
-      if (visited.find(neighbor) == visited.end()) {
-        double cost = state.cost + state.data->dist(*neighbor);
-        double g = cost + heuristic(neighbor, target); /* Add Heuristic */
-        State<Node> newState(neighbor, state.data, cost, g);
-        frontier.push(newState);
-      }
+                                   double heuristic(Node* n, Node* target)) {
+  TRACE_SCOPE("a_star");
+  vector<Node*> path;
+  auto vertices = g.adj_list.end();
+  if (g.adj_list.find(start) != vertices && g.adj_list.find(target) != vertices) {
+    LazyDenseGraph<Node> lazy(g);
+    int start_id = lazy.id(start);
+    int target_id = lazy.id(target);
+    AStar<Node> engine;
+    for (int id : engine.search(lazy, start_id, target_id, heuristic)) {
+      path.push_back(lazy.node(id));
     }
   }
 
-  cout << "Failed to find path in A*" << endl;
-  return vector<Node*>();
+  if (path.empty()) { cout << "Failed to find path in A*" << endl; }
+  return path;
 }
 
-#endif /* __SEARCH_H */
\ No newline at end of file
+#endif /* __SEARCH_H */
@@ -0,0 +1,169 @@
+/**
+ *  @file Trace.cpp
+ *  @brief Implements the tracing defined in Trace.h
+ *
+ *  @author Shashank Ojha (shashano)
+ *  @author Serris Lew (snlew)
+ *  @author David Bick (dbick)
+ *  @bug No known bugs.
+ */
+
+#include <algorithm>
+#include <climits>
+#include <cstdio>
+#include <mutex>
+#include <stdexcept>
+#include <vector>
+
+#include "Trace.h"
+
+using namespace std;
+
+/* Events of one thread. Owned by the registry rather than the thread, so the
+ * events of threads that have exited can still be written. */
+struct Trace_Buffer {
+  int tid;
+  vector<Trace_Event> events;
+  size_t dropped;
+};
+
+atomic<bool> Trace::enabled(false);
+
+/* Every buffer ever registered, guarded by registry_lock */
+static mutex registry_lock;
+static vector<Trace_Buffer*> registry;
+
+/* Buffer of the calling thread, registered on its first event */
+static thread_local Trace_Buffer *local_buffer = NULL;
+
+/**
+ * @brief Whether this build has the tracing instrumentation.
+ *
+ * @return True if PLANNER_TRACE was defined.
+ */
+bool Trace::compiled_in() {
+#ifdef PLANNER_TRACE
+  return true;
+#else
+  return false;
+#endif
+}
+
+/**
+ * @brief Starts recording scopes on all threads.
+ *
+ * @return Void.
+ */
+void Trace::start() {
+  enabled.store(true, memory_order_relaxed);
+}
+
+/**
+ * @brief Stops recording scopes. Scopes already open still record when they
+ * close.
+ *
+ * @return Void.
+ */
+void Trace::stop() {
+  enabled.store(false, memory_order_relaxed);
+}
+
+/**
+ * @brief Appends an event to the calling thread's buffer, registering the
+ * buffer the first time. Only takes a lock on a thread's first event.
+ *
+ * @param event Finished event.
+ * @return Void.
+ */
+void Trace::record(const Trace_Event &event) {
+  Trace_Buffer *buffer = local_buffer;
+  if (buffer == NULL) {
+    buffer = new Trace_Buffer();
+    buffer->dropped = 0;
+    lock_guard<mutex> guard(registry_lock);
+    buffer->tid = (int) registry.size() + 1;
+    registry.push_back(buffer);
+    local_buffer = buffer;
+  }
+  if (buffer->events.size() < TRACE_BUFFER_CAPACITY) {
+    buffer->events.push_back(event);
+  } else {
+    buffer->dropped += 1;
+  }
+}
+
+/**
+ * @brief Discards every recorded event.
+ *
+ * @return Void.
+ */
+void Trace::clear() {
+  lock_guard<mutex> guard(registry_lock);
+  for (Trace_Buffer *buffer : registry) {
+    buffer->events.clear();
+    buffer->dropped = 0;
+  }
+}
+
+/**
+ * @brief Counts the recorded events of all threads.
+ *
+ * @return Number of events.
+ */
+size_t Trace::num_events() {
+  lock_guard<mutex> guard(registry_lock);
+  size_t n = 0;
+  for (Trace_Buffer *buffer : registry) { n += buffer->events.size(); }
+  return n;
+}
+
+/**
+ * @brief Counts the events lost to full buffers.
+ *
+ * @return Number of events dropped.
+ */
+size_t Trace::dropped() {
+  lock_guard<mutex> guard(registry_lock);
+  size_t n = 0;
+  for (Trace_Buffer *buffer : registry) { n += buffer->dropped; }
+  return n;
+}
+
+/**
+ * @brief Writes every recorded event as a complete event of the Chrome trace
+ * event format, with times in microseconds from the earliest event.
+ *
+ * @param filename The file to write.
+ * @return Void.
+ */
+void Trace::write(const string &filename) {
+  FILE *file = fopen(filename.c_str(), "w");
+  if (file == NULL) {
+    throw invalid_argument("Trace::write: Unable to open file!");
+  }
+
+  lock_guard<mutex> guard(registry_lock);
+  int64_t epoch = LLONG_MAX;
+  for (Trace_Buffer *buffer : registry) {
+    for (const Trace_Event &e : buffer->events) { epoch = min(epoch, e.start_ns); }
+  }
+
+  fprintf(file, "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n");
+  const char *sep = "";
+  for (Trace_Buffer *buffer : registry) {
+    fprintf(file, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,"
+            "\"args\":{\"name\":\"planner %d\"}}", sep, buffer->tid, buffer->tid);
+    sep = ",\n";
+    for (const Trace_Event &e : buffer->events) {
+      fprintf(file, "%s{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%d,"
+              "\"ts\":%.3f,\"dur\":%.3f", sep, e.name, buffer->tid,
+              (e.start_ns - epoch) / 1000.0, (e.end_ns - e.start_ns) / 1000.0);
+      if (e.id != TRACE_NO_ID) {
+        fprintf(file, ",\"args\":{\"id\":%lld}", (long long) e.id);
+      }
+      fprintf(file, "}");
+    }
+  }
+  fprintf(file, "\n]}\n");
+  fclose(file);
+}
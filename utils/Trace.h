@@ -0,0 +1,116 @@
+/**
+ *  @file Trace.h
+ *  @brief Defines scoped timeline tracing of the planner. Every thread records
+ *  the scopes it leaves into its own buffer, and the buffers are written out
+ *  together as Chrome trace event JSON, which chrome://tracing and
+ *  ui.perfetto.dev open as a timeline.
+ *
+ *  Tracing is only compiled in when PLANNER_TRACE is defined (make TRACE=1).
+ *  Otherwise TRACE_SCOPE expands to nothing. When compiled in, a scope costs a
+ *  relaxed load and a branch until Trace::start is called.
+ *
+ *  @author Shashank Ojha (shashano)
+ *  @author Serris Lew (snlew)
+ *  @author David Bick (dbick)
+ *  @bug No known bugs.
+ */
+
+#ifndef __TRACE_H
+#define __TRACE_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+/* Most events one thread keeps, later ones are counted as dropped */
+#define TRACE_BUFFER_CAPACITY (1 << 20)
+
+/* Marks events that carry no id */
+#define TRACE_NO_ID -1
+
+using namespace std;
+
+/* One finished scope. Names are string literals, so only the pointer is
+ * kept. */
+struct Trace_Event {
+  const char *name;
+  int64_t start_ns; /* On the monotonic clock */
+  int64_t end_ns;
+  int64_t id;       /* Shown as an argument of the event, TRACE_NO_ID for none */
+};
+
+/* Process wide switch and output of the recorded events. Recording threads
+ * must be done before write or clear is called. */
+class Trace {
+  public:
+    /* Function Prototypes */
+    static bool compiled_in();
+    static void start();
+    static void stop();
+    static void clear();
+    static size_t num_events();
+    static size_t dropped();
+    static void write(const string &filename);
+    static void record(const Trace_Event &event);
+
+    /**
+     * @brief Reads the monotonic clock.
+     *
+     * @return Nanoseconds since an arbitrary epoch.
+     */
+    static inline int64_t now() {
+      return chrono::duration_cast<chrono::nanoseconds>(
+          chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    /* Data */
+    static atomic<bool> enabled;
+};
+
+/* Records the time from its construction to its destruction as one event, if
+ * tracing was on when it was constructed. */
+class Trace_Scope {
+  public:
+    /**
+     * @brief Constructor that notes the start time while tracing is on.
+     *
+     * @param name Name of the event, a string literal.
+     * @param id Number shown with the event, such as a query id.
+     * @return Scope.
+     */
+    inline Trace_Scope(const char *name, int64_t id = TRACE_NO_ID) {
+      this->event.name = name;
+      this->event.id = id;
+      this->event.start_ns =
+          Trace::enabled.load(memory_order_relaxed) ? Trace::now() : 0;
+    }
+
+    /**
+     * @brief Destructor. Records the event if the start time was noted.
+     */
+    inline ~Trace_Scope() {
+      if (this->event.start_ns != 0) {
+        this->event.end_ns = Trace::now();
+        Trace::record(this->event);
+      }
+    }
+
+    Trace_Scope(const Trace_Scope &other) = delete;
+
+  private:
+    /* Data */
+    Trace_Event event;
+};
+
+#define TRACE_CONCAT_(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_(a, b)
+
+#ifdef PLANNER_TRACE
+/* Traces the rest of the enclosing block */
+#define TRACE_SCOPE(...) Trace_Scope TRACE_CONCAT(trace_scope_, __LINE__)(__VA_ARGS__)
+#else
+#define TRACE_SCOPE(...) do {} while (0)
+#endif
+
+#endif /* __TRACE_H */
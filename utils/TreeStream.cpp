@@ -0,0 +1,199 @@
+/**
+ *  @file TreeStream.cpp
+ *  @brief Implements the tree stream and recorder defined in TreeStream.h
+ *
+ *  @author Shashank Ojha (shashano)
+ *  @author Serris Lew (snlew)
+ *  @author David Bick (dbick)
+ *  @bug No known bugs.
+ */
+
+#include <chrono>
+#include <stdexcept>
+#include <vector>
+
+#include "TreeStream.h"
+
+using namespace std;
+
+/**
+ * @brief Builds an event about the segment from A to B.
+ *
+ * @return Event.
+ */
+static Tree_Event make_event(int kind, const Point *A, const Point *B) {
+  Tree_Event event;
+  event.kind = kind;
+  event.reserved = 0;
+  event.a_id = (uint64_t) (uintptr_t) A;
+  event.b_id = (uint64_t) (uintptr_t) B;
+  event.a = *A;
+  event.b = *B;
+  return event;
+}
+
+/****************************************************************************/
+
+                              /* Tree Stream */
+
+/****************************************************************************/
+
+/**
+ * @brief Constructor for a stream with nothing in it.
+ *
+ * @param capacity Events the ring can hold, a power of two.
+ * @return Empty stream.
+ */
+Tree_Stream::Tree_Stream(size_t capacity) : events(capacity), dropped(0) {}
+
+/**
+ * @brief Pushes an event, dropping it if the ring is full. Only called by
+ * the producer.
+ *
+ * @param event Event to push.
+ * @return Void.
+ */
+void Tree_Stream::push(const Tree_Event &event) {
+  if (!this->events.push(event)) {
+    this->dropped.fetch_add(1, memory_order_relaxed);
+  }
+}
+
+/**
+ * @brief Moves the oldest events out of the ring. Only called by the
+ * consumer.
+ *
+ * @param events Array to copy events into.
+ * @param max_events Size of events.
+ * @return Number of events moved.
+ */
+size_t Tree_Stream::drain(Tree_Event *events, size_t max_events) {
+  return this->events.pop(events, max_events);
+}
+
+/**
+ * @brief Reports that a new tree starts growing from root.
+ *
+ * @param root Root of the tree.
+ * @return Void.
+ */
+void Tree_Stream::watching(Point *root) {
+  this->push(make_event(TREE_WATCH, root, root));
+}
+
+/**
+ * @brief Reports an edge joining the tree.
+ *
+ * @param A Pointer to a vertex.
+ * @param B Pointer to the other vertex.
+ * @return Void.
+ */
+void Tree_Stream::edge_added(Point *A, Point *B) {
+  this->push(make_event(TREE_ADD_EDGE, A, B));
+}
+
+/**
+ * @brief Reports an edge leaving the tree, while both vertices still exist.
+ *
+ * @param A Pointer to a vertex.
+ * @param B Pointer to the other vertex.
+ * @return Void.
+ */
+void Tree_Stream::edge_removed(Point *A, Point *B) {
+  this->push(make_event(TREE_REMOVE_EDGE, A, B));
+}
+
+/**
+ * @brief Pushes the segments of a finished path.
+ *
+ * @param path Path the planner returned.
+ * @return Void.
+ */
+void Tree_Stream::add_path(const vector<Point*> &path) {
+  for (size_t i = 1; i < path.size(); i++) {
+    this->push(make_event(TREE_PATH, path[i - 1], path[i]));
+  }
+}
+
+/****************************************************************************/
+
+                             /* Tree Recorder */
+
+/****************************************************************************/
+
+/**
+ * @brief Constructor that creates the file and starts draining the stream
+ * into it.
+ *
+ * @param stream Stream to drain, must outlive the recorder.
+ * @param filename The file to write.
+ * @return Running recorder.
+ */
+Tree_Recorder::Tree_Recorder(Tree_Stream &stream, const string &filename)
+  : stream(stream), num_events(0), stopping(false) {
+  this->file = fopen(filename.c_str(), "wb");
+  if (this->file == NULL) {
+    throw invalid_argument("Tree_Recorder Constructor: Unable to open file!");
+  }
+  uint32_t header[2] = {TREE_STREAM_MAGIC, TREE_STREAM_VERSION};
+  fwrite(header, sizeof(header), 1, this->file);
+  this->worker = thread(&Tree_Recorder::run, this);
+}
+
+/**
+ * @brief Destructor. Writes whatever is still in the stream and closes the
+ * file.
+ */
+Tree_Recorder::~Tree_Recorder() {
+  this->stopping.store(true);
+  this->worker.join();
+  fclose(this->file);
+}
+
+/**
+ * @brief Recorder loop. Writes events in batches through stdio's buffer and
+ * naps while the stream is empty.
+ *
+ * @return Void.
+ */
+void Tree_Recorder::run() {
+  vector<Tree_Event> batch(TREE_DRAIN_BATCH);
+  while (true) {
+    bool last = this->stopping.load();
+    size_t n = this->stream.drain(batch.data(), batch.size());
+    fwrite(batch.data(), sizeof(Tree_Event), n, this->file);
+    this->num_events += n;
+    if (n == 0) {
+      if (last) { return; }
+      this_thread::sleep_for(chrono::milliseconds(1));
+    }
+  }
+}
+
+/**
+ * @brief Reads every event of a recorded stream.
+ *
+ * @param filename File written by a Tree_Recorder.
+ * @return Events in the order they were recorded.
+ */
+vector<Tree_Event> read_tree_events(const string &filename) {
+  FILE *file = fopen(filename.c_str(), "rb");
+  if (file == NULL) {
+    throw invalid_argument("read_tree_events: Unable to open file!");
+  }
+  uint32_t header[2];
+  if (fread(header, sizeof(header), 1, file) != 1 ||
+      header[0] != TREE_STREAM_MAGIC || header[1] != TREE_STREAM_VERSION) {
+    fclose(file);
+    throw invalid_argument("read_tree_events: Not a tree stream!");
+  }
+
+  vector<Tree_Event> events;
+  Tree_Event batch[TREE_DRAIN_BATCH];
+  size_t n;
+  while ((n = fread(batch, sizeof(Tree_Event), TREE_DRAIN_BATCH, file)) > 0) {
+    events.insert(events.end(), batch, batch + n);
+  }
+  fclose(file);
+  return events;
+}
@@ -0,0 +1,97 @@
+/**
+ *  @file TreeStream.h
+ *  @brief Defines a stream of changes to the tree a planner is growing. The
+ *  planner thread pushes events into a lock-free ring buffer and a viewer or
+ *  recorder thread drains them, so watching a plan costs the planner little
+ *  more than a copy per edge.
+ *
+ *  @author Shashank Ojha (shashano)
+ *  @author Serris Lew (snlew)
+ *  @author David Bick (dbick)
+ *  @bug No known bugs.
+ */
+
+#ifndef __TREE_STREAM_H
+#define __TREE_STREAM_H
+
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "Graph.h"
+#include "Point.h"
+#include "RingBuffer.h"
+
+#define TREE_STREAM_MAGIC 0x45455254 /* "TREE" */
+#define TREE_STREAM_VERSION 1
+
+/* Kinds of events */
+#define TREE_WATCH 0       /* A new tree starts growing from a */
+#define TREE_ADD_EDGE 1
+#define TREE_REMOVE_EDGE 2
+#define TREE_PATH 3        /* Segment of the path the planner returned */
+
+/* Number of events moved out of the ring at once */
+#define TREE_DRAIN_BATCH 1024
+
+using namespace std;
+
+/* Vertices are identified by their address, which is unique while they are
+ * in the tree, and carry their coordinates so no one has to look them up. */
+struct Tree_Event {
+  int32_t kind;
+  uint32_t reserved;
+  uint64_t a_id;
+  uint64_t b_id;
+  Point a;
+  Point b;
+};
+
+/* Graph_Listener that pushes every change into a ring buffer. Changes that
+ * arrive while the ring is full are dropped and counted rather than making
+ * the planner wait. */
+class Tree_Stream : public Graph_Listener<Point> {
+  public:
+    /* Data */
+    RingBuffer<Tree_Event> events;
+    atomic<long> dropped;
+
+    /* Constructors */
+    Tree_Stream(size_t capacity);
+
+    /* Function Prototypes */
+    void watching(Point *root);
+    void edge_added(Point *A, Point *B);
+    void edge_removed(Point *A, Point *B);
+    void add_path(const vector<Point*> &path);
+    void push(const Tree_Event &event);
+    size_t drain(Tree_Event *events, size_t max_events);
+};
+
+/* Drains a Tree_Stream into a file on its own thread until it is destroyed */
+class Tree_Recorder {
+  public:
+    /* Data */
+    Tree_Stream &stream;
+    FILE *file;
+    long num_events;
+
+    /* Constructors */
+    Tree_Recorder(Tree_Stream &stream, const string &filename);
+    Tree_Recorder(const Tree_Recorder &other) = delete;
+    ~Tree_Recorder();
+
+  private:
+    atomic<bool> stopping;
+    thread worker;
+
+    void run();
+};
+
+/* Function Prototypes */
+vector<Tree_Event> read_tree_events(const string &filename);
+
+#endif /* __TREE_STREAM_H */